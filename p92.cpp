@@ -16,12 +16,13 @@ Therefore any chain that arrives at 1 or 89 will become stuck in an endless loop
 How many starting numbers below ten million will arrive at 89?
 """
 
-This program is compiled with "g++ -Wall p92.cpp -o p92
+This program is compiled with "g++ -std=c++14 -pedantic-errors -Wextra -Wall -pthread -O2 p92.cpp -o p92" (see the README for the production and instrumented builds)
 For the sake of readability I'm going to define this term:
 -> "squigit":
 "squigit" refers to the sum of the squared digits of a given number. For example, the squigit of 89 is 145, the squigit of 20 is 4, etc.
 
 I am also going to self-impose a constraint that I cannot do ANY pre-calculation to help, every method must start from scratch and only use mathematical concepts to help optimize, I'm not allowed to create lookup tables or pre-compute any data for each method - it has to be done from scratch for each method.
+(The one exception is the production build, compiled with an extra -DP92_PRODUCTION, where the compiler does all of the pre-calculation instead, more on that below the prototypes.)
  */
 
 
@@ -40,398 +41,4119 @@ IDEAS:
 
 
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
+#ifdef P92_INSTRUMENT
+#include <cstdlib>
+#include <new>
+#endif
+
+// POSIX, for the plain write()s that OutputBuffer flushes with and the mmap() behind BitsetFile
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(P92_INSTRUMENT) && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#define P92_PERF_EVENTS
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define P92_X86_SIMD
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define P92_NEON_SIMD
+#endif
+
 using namespace std::chrono;
 
+typedef uint8_t u8;
+typedef uint16_t u16;
 typedef uint32_t u32; // just a convenient shorthand
+typedef uint64_t u64;
+__extension__ typedef unsigned __int128 u128; // gcc/clang extension, __extension__ keeps -pedantic-errors quiet about it
 
-const u32 TEN_MILLION{10000000};
+const u32 DEFAULT_DIGITS{7}; // the original problem: starting numbers below ten million = 10^7
+const u32 MAX_SCAN_DIGITS{19}; // 10^19 is the biggest power of ten that still fits in a u64, so this is as far as any method that loops over the numbers themselves can go
+const u32 MAX_COUNT_DIGITS{38}; // 10^38 is the biggest power of ten that fits in a u128, past this even the answer itself doesn't fit
 
+const u32 CHUNK_DIGITS{4}; // squigit_chunked() eats this many digits per table lookup
+const u32 CHUNK_SIZE{10000}; // 10^CHUNK_DIGITS table entries, as u16 that's 20KB so it stays in L1
+const u32 MAX_THREADS{256};
+const u32 MAX_MODULAR_DIGITS{10000}; // the modular DP doesn't overflow at all, but it's O(N^2), 10^3000 already takes a few seconds and this about a minute
+const u32 MAX_EXACT_DIGITS{1000}; // the exact answer runs that DP once for every ~60 bit prime it needs, about N / 18 of them, so it's O(N^3) and 10^1000 takes 20 seconds
+const u32 MAX_NTT_DIGITS{1000000}; // 81 million coefficients, the transforms are 2^27 u64s (1GB) each at that point
+const u32 SIMD_BATCH{16}; // numbers per squigit_batch_kernel() call, 10000 is a multiple of 16 so an aligned batch never straddles two 4 digit chunks
 
-u32 squigit(u32 val);
-u32 power(u32 base, u32 exp);
 
+constexpr u32 squigit(u64 val);
+constexpr u64 power(u64 base, u32 exp);
+u32 squigit_bound(u32 digits);
+std::string u128_to_string(u128 val);
+u128 checked_mul(u128 a, u128 b);
+u128 mul_div_exact(u128 val, u32 mul, u32 div);
+u128 multinomial(const u32 *counts, u32 parts);
+std::vector<std::vector<u128>> squigit_distributions(u32 digits);
+u64 count_89_mod(u32 digits, u64 modulus);
+std::string count_89_exact(u32 digits);
+u64 count_89_ntt(u32 digits);
+const u16 *chunk_squigits();
+u32 squigit_chunked(u64 val);
 
-// base class
-class Method {   
-private:   
-   virtual u32 solve() const = 0;
-   
-public:   
-   std::string class_type{};
-   void print_results() const
-   {
-      milliseconds time{};
-   
-      auto start = high_resolution_clock::now();
-      u32 ans = solve();
-      auto stop = high_resolution_clock::now();
+class TerminalBitset;
+
+typedef void (*SquigitBatchFn)(u32 high_squigit, u32 low, u32 *out);
+typedef u32 (*Count89BatchFn)(u32 high_squigit, u32 low, const TerminalBitset &reaches_89);
+SquigitBatchFn squigit_batch_kernel();
+Count89BatchFn count_89_batch_kernel();
+const char *squigit_batch_isa();
+
+
+// these two are constexpr so the production build below can build its tables out of them at compile time, which means they have to be defined up here before anything uses them
 
-      time = duration_cast<milliseconds>(stop - start);
 
-      std::cout << class_type << " result: " << ans << ", exection time in ms: " << time.count() << '\n';
+constexpr u64 power(u64 base, u32 exp)
+{
+   u64 ans{1};
+   while(exp != 0) {
+      ans *= base;
+      --exp;
    }
-};
+   return ans;
+}
 
 
-// this is the most naive and brute-force approach, it simply loops through all ten million numbers and then checks to see if it reaches 89, and if it does, it increments a counter.
-class BruteForceMethod : public Method {
-private:
-   u32 solve() const {
-      u32 numbers_ending_with_89{0};
+constexpr u32
+squigit(u64 val)
+{
+   u32 ans{0};
+   
+   u32 i = 1;
+   while(val != 0) {
+      u64 mod_val = val % power(10, i);
+      val -= mod_val;
+      ans += static_cast<u32>((mod_val / power(10, i - 1)) * (mod_val / power(10, i - 1)));
+      ++i;
+      // std::cout << "val: " << val << ", ans: " << ans << ", mod val:" << mod_val << "\n";
+   }
    
-      for(u32 i = 1; i < TEN_MILLION; ++i) {
-	 u32 current_chain_number{i};
+   return ans;
+}
 
-	 u32 chain_length{0};
-	 while(true) {
-	    u32 val = squigit(current_chain_number);
-	 
-	    if(val == 89) {
-	       ++numbers_ending_with_89;
-	       break;
-	    } else if(val == 1) {
-	       break;
-	    } else {
-	       current_chain_number = val;
-	    }
 
-	    ++chain_length;
-	 }
+/*
+The production build (compile with -DP92_PRODUCTION) is for when we just want the answers fast and don't care about my rule at the top: every table the methods need gets worked out by the compiler from the constexpr squigit() and power() above, so at runtime there's nothing left to build and solve() only does the counting:
+- the chunk squigits for squigit_chunked(),
+- where every squigit up to squigit_bound(MAX_COUNT_DIGITS) ends up, which ChainOracle answers from and fills its tables out of instead of running find_cycles(),
+- and the binomials up to MAX_COUNT_DIGITS for for_each_digit_multiset() (instead of factorials, since 35! already overflows a u128 but no binomial we need does).
+It takes the compiler a few extra seconds. The normal build still works everything out from scratch at runtime.
+ */
+#ifdef P92_PRODUCTION
+const u32 PRODUCTION_BOUND{81 * MAX_COUNT_DIGITS};
 
-	 
-	 // I wanted to see how long a chain was, meaning how many numbers after a given starting number does it take to get to 89 or 1, apparently it's under 12 because this statement doesn't execute at all for all 9999999 numbers we check - uncomment the next line so this code can run.
-	 // #define TEST_CHAIN
-	 #ifdef TEST_CHAIN
-	 if(chain_length >= 12) {
-	    std::cout << "chain length: " << chain_length << "\n";
-	 }
-	 #endif
-      }
+struct ChunkSquigitTable {
+   u16 values[CHUNK_SIZE];
+};
 
-      return numbers_ending_with_89;
-   }
+struct TerminalTable {
+   u8 values[PRODUCTION_BOUND + 1]; // 1 or 89, and 0 for 0
+};
 
-public:
-   BruteForceMethod()
-   {
-      class_type = std::string{"brute_force_method"};
-   }
+struct BinomialTable {
+   u128 values[MAX_COUNT_DIGITS + 1][MAX_COUNT_DIGITS + 1]; // values[n][k] = (n choose k)
 };
 
+constexpr ChunkSquigitTable make_chunk_squigit_table()
+{
+   ChunkSquigitTable table{};
+   for(u32 i = 0; i < CHUNK_SIZE; ++i) {
+      table.values[i] = static_cast<u16>(squigit(i));
+   }
+   return table;
+}
 
-// This is similar to the above method, but it also makes use of a cache that is updated every loop iteration to include numbers that we know will reach 89, which speeds things up a bit.
-class BruteForceMethodCached : public Method {
-private:
-   u32 solve() const
-   {
-      bool numbers_that_goto_89[567];
-      bool numbers_that_goto_1[567];
-      for(u32 i = 0; i < 567; ++i) {
-	 numbers_that_goto_1[i] = false;
-	 numbers_that_goto_89[i] = false;
+constexpr TerminalTable make_terminal_table()
+{
+   TerminalTable table{};
+   for(u32 i = 1; i <= PRODUCTION_BOUND; ++i) {
+      u32 val{i};
+      while(val != 1 && val != 89) {
+	 val = squigit(val);
       }
-      
-      u32 numbers_ending_with_89{0};
-   
-      for(u32 i = 1; i < TEN_MILLION; ++i) {
-	 
-	 u32 current_chain_number{i};
-	 std::vector<u32> chain_numbers{}; // if this chain ends in 89, we will cache all these numbers in a sorted vector, otherwise if they go to 1 we'll put them in a different vector
-	 bool goes_to_1{false};
-
-	 while(true) {
-	    u32 val = squigit(current_chain_number);
-	 
-	    if(val == 89 || numbers_that_goto_89[val]) {
-	       ++numbers_ending_with_89;
-	       break;
-	    } else if(val == 1 || numbers_that_goto_1[val]) {
-	       goes_to_1 = true;
-	       break;
-	    } else {
-	       current_chain_number = val;
-	       chain_numbers.push_back(val);
-	    }
-	 }
+      table.values[i] = static_cast<u8>(val);
+   }
+   return table;
+}
 
-	 if(goes_to_1) {
-	    for(u32 i = 0; i < chain_numbers.size(); ++i) {
-	       numbers_that_goto_1[chain_numbers[i]] = true;
-	    }
-	 } else {
-	    for(u32 i = 0; i < chain_numbers.size(); ++i) {
-	       numbers_that_goto_89[chain_numbers[i]] = true;
-	    }
-	 }
+// Pascal's triangle, the biggest entry is (38 choose 19) so nothing comes close to overflowing
+constexpr BinomialTable make_binomial_table()
+{
+   BinomialTable table{};
+   for(u32 n = 0; n <= MAX_COUNT_DIGITS; ++n) {
+      table.values[n][0] = 1;
+      for(u32 k = 1; k <= n; ++k) {
+	 table.values[n][k] = table.values[n - 1][k - 1] + (k < n ? table.values[n - 1][k] : 0);
       }
+   }
+   return table;
+}
 
-      // std::cout << numbers_that_goto_89.size() << '\n';
+constexpr ChunkSquigitTable PRODUCTION_CHUNK_SQUIGITS = make_chunk_squigit_table();
+constexpr TerminalTable PRODUCTION_TERMINALS = make_terminal_table();
+constexpr BinomialTable PRODUCTION_BINOMIALS = make_binomial_table();
 
-      return numbers_ending_with_89;
-   }
-public:
-   BruteForceMethodCached()
-   {
-      class_type = std::string{"brute_force_method_cached"};
-   }
-};
+static_assert(PRODUCTION_CHUNK_SQUIGITS.values[9999] == 324, "chunk squigit table is off");
+static_assert(PRODUCTION_TERMINALS.values[85] == 89 && PRODUCTION_TERMINALS.values[44] == 1, "terminal table is off");
+#endif
 
 
 /*
-This method is similar to BruteForceMethodCached, but it creates the cache of numbers beforehand using the trick that all the possible squigits of 1 to 9999999 is 9^2 * 7 = 567, so we only need to check 567 values which is pretty small, and then we can cache the result immediately and then just loop through all ten million values - it's prety much the same as BruteForcedMethodCached but slightly different - and it turns out that it helps speed things up a little bit, possibly because we aren't constantly adding to a cache each loop iteration, but just perfoming a simple lookup with the index of the number we want to check.
+The instrumented build (compile with -DP92_INSTRUMENT) counts what the methods actually do in their hot loops, so we can see why some of them end up the same speed instead of guessing: every squigit actually worked out (the odometer and the blocked kernel's table reads don't count, they never work one out), every lookup in BruteForceMethodCached's cache that answered straight away (a hit) or that didn't and we had to take another step (a miss), every step along a chain after the first squigit, and every call to operator new. When perf_event_open lets us, it reads the cycles, branch misses and L1 data cache misses off the CPU as well (see Profiler below).
+The counters are relaxed atomics, so the threads keep fighting over the same cache lines and the instrumented build is a fair bit slower, which is why none of this is in the normal build: there P92_COUNT() is nothing at all and the loops compile exactly like they did before.
  */
-class SquigitsMethod : public Method {
-private:
-   
-   u32 solve() const
-   {
-      bool squigits_to_1[1024]; // since there are much less squigits that go to 1, we simply only keep track of these, and if a number's squigit is NOT in here, then it goes to 89, so it should be fast to check this small array.
+#ifdef P92_INSTRUMENT
+struct InstrumentCounters {
+   std::atomic<u64> squigit_calls{0};
+   std::atomic<u64> cache_hits{0};
+   std::atomic<u64> cache_misses{0};
+   std::atomic<u64> chain_steps{0};
+   std::atomic<u64> allocations{0};
+};
 
-      for(u32 i = 1; i <= 567; ++i) {
-	 u32 val{i};
-	 while(true) {
-	    if(val == 1) {
-	       squigits_to_1[i] = true;
-	       break;
-	    }
-	    if(val == 89) {
-	       squigits_to_1[i] = false;
-	       break;
-	    }
-	    val = squigit(val);
-	 }
-      }
+// constant initialized, so it's already there for any operator new that runs before main()
+InstrumentCounters instrument_counters{};
 
-      u32 ans{0};
-      for(u32 i = 1; i < TEN_MILLION; ++i) {
-	 if(!squigits_to_1[squigit(i)]) {
-	    ++ans;
-	 }
-      }
+#define P92_COUNT_BY(counter, n) (instrument_counters.counter.fetch_add(n, std::memory_order_relaxed))
+#define P92_COUNT(counter) P92_COUNT_BY(counter, 1)
 
-      return ans;
-   }
-   
-public:
-   
-   SquigitsMethod()
-   {
-      class_type = std::string{"squigits_method"};
+void *operator new(std::size_t size)
+{
+   P92_COUNT(allocations);
+   if(void *ptr = std::malloc(size == 0 ? 1 : size)) {
+      return ptr;
    }
-};
+   throw std::bad_alloc{};
+}
+
+// noinline, or gcc inlines the free() into code it knows got its memory from operator new and warns that they don't match
+__attribute__((noinline)) void operator delete(void *ptr) noexcept
+{
+   std::free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void *ptr, std::size_t) noexcept
+{
+   std::free(ptr);
+}
+#else
+#define P92_COUNT_BY(counter, n) ((void)0)
+#define P92_COUNT(counter) ((void)0)
+#endif
 
 
 /*
-All the other methods have been ignoring the fact that several combinations of numbers produce the same squigit, such as: [10, 1000, 1000], or [57, 705, 7005, 5007]
-We can exploit this by enumerating all possible combinations and then checking to see if a given combination reaches 89 eventually, the trick will be to figure out how many starting numbers a given combination corresponds to. We also need to figure out how to enumerate all possible combinations, NOT permutations, which should shrink how many iterations our main loop will be by a large percentage.
+squigit() is the reference implementation and it's what every method uses by default, but it does a couple of power() calls and divisions for every digit. The "fast kernels" below get rid of most of that, but they need a lookup table, which breaks my no pre-calculation rule at the top, so they're opt-in for the methods that scan every number and never a silent replacement.
+ */
+enum class SquigitKernel {
+   reference, // squigit(), digit by digit and from scratch
+   chunked, // squigit_chunked(), splits the number into 4 digit chunks and looks each one up in chunk_squigits(), so 2 lookups for 7 digit numbers
+   incremental, // SquigitOdometer, only works when going through numbers in order but then it doesn't need any table either
+   blocked, // chunk_squigits() again, but going through the numbers one chunk of CHUNK_SIZE at a time so each number is one lookup and an add, see for_each_squigit()
+};
 
-Inspired from the recursive method described here: "https://stackoverflow.com/questions/12991758/creating-all-possible-k-combinations-of-n-items-in-c", we generate all combinations and then iterate over them, which turns out to be 11440 combinations! 11440 is much less than 10,000,000 to loop over - and then with each combination we compute to see if it goes to 89 using the squigit method, and then if it does, we generate the permutations from this combination which gives us how many starting numbers this combination permutates to.
 
-Once we have all combinations, we'll need to then figure out if it runs to 89 (that's easy, we'll use the squigits method), and then we'll need to figure out how many permutations we can make from these combinations
-We don't have a clean permutation formula because repeated contiguous elements are indistinguishable, such as 1111. It doesn't matter what order those 1's are in, it equals the same. But using this post on math stack exchange: "https://math.stackexchange.com/questions/2005441/possible-numbers-from-given-numbers-using-permutations-and-combinaitions", I figured out how to calulate the permutations using the "rule of product", and with this we have our DigitsMethod which is the fastest and most efficient I was able to come up with.
+/*
+When we go through numbers in order, i and i + 1 have the exact same digits apart from the last few, so there's no reason to work out the squigit of i + 1 from scratch. This keeps the digits like an odometer along with the running squigit, and an increment only touches the digits that actually roll over.
+Bumping a digit from d - 1 to d adds d^2 - (d - 1)^2 = 2d - 1 to the squigit, and a 9 rolling over to 0 takes away 81. Only 1 in 10 increments carries at all, 1 in 100 carries twice and so on, so it's O(1) amortized per number.
  */
-class DigitsMethod : public Method {
-   
+class SquigitOdometer {
 private:
+   u32 number_digits[20]{}; // least significant first, 20 digits covers all of u64
+   u32 sum{0};
 
-   // simple function for printing vector
-   static void print_vector(const std::vector<u32> &vec)
+public:
+   explicit SquigitOdometer(u64 start)
    {
-      std::cout << "VECTOR -> { ";
-      for(u32 num : vec) {
-	 std::cout << num << ",";
+      for(u32 i = 0; start != 0; ++i) {
+	 number_digits[i] = static_cast<u32>(start % 10);
+	 sum += number_digits[i] * number_digits[i];
+	 start /= 10;
       }
-      std::cout << " }\n";
    }
 
-   // prints a 2D vector
-   static void print_2D_vector(const std::vector<std::vector<u32>> &vec)
+   u32 value() const
    {
-      for(std::vector<u32> v : vec) {
-	 print_vector(v);
-      }
+      return sum;
    }
 
-   // helper for calculating factorial of a number
-   static u32 fact(u32 num)
+   void next()
    {
-      u32 ans{1};
-      while(num != 1) {
-	 ans *= num;
-	 --num;
-      }
-      return ans;
-   }
-   
-   // simple helper method for removing specific element in a vector, only removes first occurence of element, and returns a copy of the new array without the element (I could have also passed in a reference and modified the vector in-place, but while I was working on this DigitsMethod I though it would be better to have a return-by-copy in case I needed it)
-   static std::vector<u32> remove_element(std::vector<u32> nums, u32 val)
-   {      
-      for(u32 i = 0; i < nums.size(); ++i) {
-	 if(nums[i] == val) {
-	    nums.erase(nums.begin() + i);
-	    return nums;
-	 }
+      u32 i{0};
+      while(number_digits[i] == 9) {
+	 number_digits[i] = 0;
+	 sum -= 81;
+	 ++i;
       }
-      return nums;
+      ++number_digits[i];
+      sum += 2 * number_digits[i] - 1;
    }
-   
-   // creates all combinations of elements with r choose elements
-   static std::vector<std::vector<u32>> combination(std::vector<u32> elements, u32 r) 
-   {
-      if(r == 1) {
-	 std::vector<std::vector<u32>> ans{};
-	 for(auto element : elements) {
-	    ans.push_back(std::vector<u32>{element});
-	 }
-	 return ans;
-      } else {
-	 std::vector<std::vector<u32>> return_val{};
+};
 
-	 std::vector<u32> elements_to_use = elements;
-	 for(auto element : elements) {
-	    auto combos = combination(elements_to_use, r - 1);
-	    
-	    for(auto combo : combos) {
-	       combo.push_back(element);
-	       return_val.push_back(combo);
-	    }
 
-	    elements_to_use = remove_element(elements_to_use, element);
-	 }	
-	 
-	 return return_val;
-      }
+// the same as squigit_chunked(u64) but with the table passed in, so hot loops only fetch the table once
+inline u32 squigit_chunked(u64 val, const u16 *chunks)
+{
+   u32 ans{0};
+   while(val >= CHUNK_SIZE) {
+      ans += chunks[val % CHUNK_SIZE];
+      val /= CHUNK_SIZE;
    }
-   
-   u32 solve() const
-   {
-      bool squigits_to_1[1024];
+   return ans + chunks[val];
+}
 
-      for(u32 i = 1; i <= 567; ++i) {
-	 u32 val{i};
-	 while(true) {
-	    if(val == 1) {
-	       squigits_to_1[i] = true;
-	       break;
-	    }
-	    if(val == 89) {
-	       squigits_to_1[i] = false;
-	       break;
-	    }
-	    val = squigit(val);
+
+/*
+calls f(squigit) for the squigit of every number in [first, last), using whichever kernel was picked, all the scanning methods go through here
+The blocked kernel splits every number into high = i / CHUNK_SIZE and low = i % CHUNK_SIZE and goes through them high first, so the squigit of the high half only gets worked out once per CHUNK_SIZE numbers and the inner loop is just high_squigit + chunks[low] for low going up one at a time: no division, no digits, and a straight pass over the chunk table that the compiler can vectorize. The block is the chunk table itself, 10^4 u16s is 20KB and it stays in L1 next to whatever f() looks the squigit up in (10^5 would be 200KB and spill out into L2, and with 10^3 the high half gets worked out ten times as often for nothing).
+ */
+template<typename F>
+void for_each_squigit(u64 first, u64 last, SquigitKernel kernel, F &&f)
+{
+   if(kernel == SquigitKernel::chunked) {
+      const u16 *chunks = chunk_squigits();
+      for(u64 i = first; i < last; ++i) {
+	 P92_COUNT(squigit_calls);
+	 f(squigit_chunked(i, chunks));
+      }
+   } else if(kernel == SquigitKernel::incremental) {
+      SquigitOdometer odometer{first};
+      for(u64 i = first; i < last; ++i) {
+	 f(odometer.value()); // a couple of adds, not a squigit worked out, so it doesn't count as a squigit call
+	 odometer.next();
+      }
+   } else if(kernel == SquigitKernel::blocked) {
+      const u16 *chunks = chunk_squigits();
+      for(u64 high = first / CHUNK_SIZE; high * CHUNK_SIZE < last; ++high) {
+	 P92_COUNT(squigit_calls); // the inner loop only looks the low half up, so this is the only squigit worked out per block
+	 const u32 high_squigit = squigit_chunked(high, chunks); // chunks[0] is 0, so this works for the first block too
+	 const u32 low_first = static_cast<u32>(std::max(first, high * CHUNK_SIZE) - high * CHUNK_SIZE);
+	 const u32 low_last = static_cast<u32>(std::min<u64>(last - high * CHUNK_SIZE, CHUNK_SIZE));
+	 for(u32 low = low_first; low < low_last; ++low) {
+	    f(high_squigit + chunks[low]);
 	 }
       }
+   } else {
+      for(u64 i = first; i < last; ++i) {
+	 P92_COUNT(squigit_calls);
+	 f(squigit(i));
+      }
+   }
+}
 
-      
-      std::vector<u32> nums{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
-      std::vector<std::vector<u32>> combinations = combination(nums, 7);
 
-      
-      u32 ans{0};
-      
-      for(auto combo : combinations) {
-	 u32 squigit_val{0};
-	 for(u32 num : combo) {
-	    squigit_val += squigit(num);
-	 }
+// squigits_to_1[s] is true when the chain starting at s ends up at 1, and since every chain ends up at 1 or 89 that means s goes to 89 when it's false (0 goes to neither, and is false). It's never written to once it's been handed out, so all the threads can read the same one
+typedef std::shared_ptr<const std::vector<char>> SquigitTable;
 
-	 // if we get a number running to 89, we then calculate all permutations this combo will make using the rule of product, also we're checking to see if squigit_val is not 0 because if it is it will add another value to our 89 count which would be a bug
-	 if(squigit_val != 0 && !squigits_to_1[squigit_val]) {
-	    u32 starting_numbers{0};
 
-	    starting_numbers = fact(combo.size());
+/*
+The same information as a squigits_to_1 table, but one bit per value instead of a whole byte, with the bit set when the value goes to 89. For 7 digits it makes no difference (567 bytes fit in L1 either way), but the table has 81 * N entries, so for hundreds of digits or for a table of every number below 10^k it's 8 times less memory to keep in cache.
+Checking a value is a shift and a mask with no branch, so it drops straight into a counting loop as ans += reaches_89(val).
+ */
+class TerminalBitset {
+private:
+   std::vector<u64> words{};
 
-	    int duplicates[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-	    for(u32 val : combo) {
-	       ++duplicates[val];
-	    }
+public:
+   explicit TerminalBitset(u64 size)
+      : words((size + 63) / 64, 0)
+   {
+   }
 
-	    for(u32 i = 0; i < 10; ++i) {
-	       if(duplicates[i] > 0) {
-		  starting_numbers = starting_numbers / fact(duplicates[i]);
-	       }
-	    }
+   void set(u64 i)
+   {
+      words[i >> 6] |= u64{1} << (i & 63);
+   }
 
-	    ans += starting_numbers;
-	 }
-      }
-      
-      return ans;
+   u64 reaches_89(u64 i) const
+   {
+      return (words[i >> 6] >> (i & 63)) & 1;
    }
-public:
-   DigitsMethod()
+
+   const std::vector<u64> &data() const
    {
-      class_type = std::string{"digits_method"};
+      return words;
    }
 };
 
+typedef std::shared_ptr<const TerminalBitset> SquigitBitset;
 
-int main()
-{
-   std::cout << "Solving Problem 92" << '\n';
 
+// which cycle every value from 0 up to some limit ends up in, see find_cycles()
+struct CycleMap {
+   std::vector<u32> ids{}; // ids[v] = the cycle v ends up in, an index into cycles
+   std::vector<std::vector<u32>> cycles{}; // every cycle, starting from its smallest number, sorted by that number (so {0} always comes first)
+};
+
+typedef std::shared_ptr<const CycleMap> SquigitCycles;
 
-   const BruteForceMethod brute_force_method{};
-   const BruteForceMethodCached brute_force_method_cached{};
-   const SquigitsMethod squigits_method{};
-   const DigitsMethod digits_method{};
 
-   brute_force_method.print_results(); // brute force method takes about 3 seconds on my machine, fairly slow
+/*
+Nothing about finding cycles needs to know they're 1 and 89, so this works for any step that never leaves 0..limit (like squigit() up to squigit_bound(), or any of the DigitPowerFamily sums up to their bound).
+It's one pass with a visited array: from every value we haven't seen yet we follow the chain, marking everything on it as "on the path", until we either run into a value that already has a cycle (so the whole path gets that one) or run into our own path again, in which case everything from there on is a brand new cycle and the rest of the path leads into it. Every value gets walked over once, so it's linear in limit.
+ */
+template<typename Step>
+CycleMap find_cycles(u32 limit, Step &&step)
+{
+   const u32 UNSEEN{0xFFFFFFFF};
+   const u32 ON_PATH{0xFFFFFFFE};
    
-   brute_force_method_cached.print_results(); // cached method seems to be about twice as fast, taking about 1.5 seconds on my machine
+   CycleMap map{};
+   map.ids.assign(u64{limit} + 1, UNSEEN);
+   std::vector<u32> path{};
    
-   squigits_method.print_results(); // this method is just slighlty faster than the previous, I usually get about a 350 millisecond difference on average
+   for(u32 v = 0; v <= limit; ++v) {
+      if(map.ids[v] != UNSEEN) {
+	 continue;
+      }
+
+      path.clear();
+      u32 x{v};
+      while(map.ids[x] == UNSEEN) {
+	 map.ids[x] = ON_PATH;
+	 path.push_back(x);
+	 x = static_cast<u32>(step(x));
+	 if(x > limit) {
+	    throw std::out_of_range{"find_cycles() stepped from " + std::to_string(path.back()) + " to " + std::to_string(x) + ", past its limit of " + std::to_string(limit)};
+	 }
+      }
 
-   digits_method.print_results(); // this method is IT! it is staggeringly fast compared to the others, and probably scales much better. On average it takes 45ms to run this!! Which is a HUGE improvement.
+      u32 id{map.ids[x]};
+      if(id == ON_PATH) {
+	 const auto start = std::find(path.begin(), path.end(), x);
+	 std::vector<u32> cycle(start, path.end());
+	 std::rotate(cycle.begin(), std::min_element(cycle.begin(), cycle.end()), cycle.end());
+	 id = static_cast<u32>(map.cycles.size());
+	 map.cycles.push_back(cycle);
+      }
+      for(u32 y : path) {
+	 map.ids[y] = id;
+      }
+   }
 
+   // number them by their smallest values instead of the order we found them in
+   std::vector<u32> order(map.cycles.size());
+   for(u32 i = 0; i < order.size(); ++i) {
+      order[i] = i;
+   }
+   std::sort(order.begin(), order.end(), [&map](u32 a, u32 b) { return map.cycles[a][0] < map.cycles[b][0]; });
+   std::vector<u32> renumber(order.size());
+   std::vector<std::vector<u32>> sorted(order.size());
+   for(u32 i = 0; i < order.size(); ++i) {
+      renumber[order[i]] = i;
+      sorted[i] = std::move(map.cycles[order[i]]);
+   }
+   map.cycles = std::move(sorted);
+   for(u32 &id : map.ids) {
+      id = renumber[id];
+   }
    
-   /* 
-Interestingly, when I enable -O2 in the compiler, the difference between BruteForceMethodCached and SquigitsMethod shrinks to almost nothing, about only a 5-10ms difference on average. I'm not sure what the compiler is doing to achieve that but they both boil out to be close to the same speed with gcc -O2 optimization level. (SquigitsMethod is just every so slightly faster though)
-Also, DigitsMethod only takes 6ms on average!! Which is less than 1% of a second!!
-   */
-  
-   
-   /*
-THINGS I LEARNED:
-- it turns out for the cached method we only need a cache size of 567 elements because 9^2 * 7 = 567, so we don't need a massive cache size like I thought before, which would have made it way too slow.
-- under ten million, chains are at most 12 long, including the starting number.
-- trying to create an inverse (squigit) was difficult, I couldn't find a way to efficiently calculate a list of numbers that squigit to X without looping over all ten million numbers and checking, we might as well just bruteforce it if that's the case - I was going to try to make a tree with 89 or 1 at the root but that fell apart, perhaps it could be done but I don't know if it could possibly be better than the DigitsMethod.
-- combinatorics is useful for eliminating the amount of cases you have to deal with, especially for large sets of data, which is a very huge optimization in this case.
-    */
-   
-   return 0;
+   return map;
 }
 
 
-u32 power(u32 base, u32 exp)
-{
-   u32 ans{1};
-   while(exp != 0) {
-      ans *= base;
-      --exp;
-   }
-   return ans;
-}
+/*
+Every method that needed to know where the squigits go used to work out its own squigits_to_1 from scratch in solve(), chain by chain from 1 to 567, which is the same work over and over again once we run several methods (or the same one several times) in a row.
+So instead there's just this one, shared by everything in the process. It runs find_cycles() over the squigit once and keeps the result, and everything it says about where a value ends up comes from terminal_locked() on top of that, so terminal() and the tables can never disagree. squigits_to_1() hands out a finished table covering 0..bound for the hot loops, and keeps it around for whoever asks for the same (or a smaller) bound next.
+In the production build terminal_locked() answers from PRODUCTION_TERMINALS instead for everything up to PRODUCTION_BOUND, so the tables get copied out of what the compiler worked out and find_cycles() only ever runs for a bound past that.
+ */
+class ChainOracle {
+private:
+   std::mutex lock{};
+   SquigitTable table{};
+   SquigitBitset bitset{};
+   u32 bitset_bound{0}; // the bound bitset was built for, its last word can have more bits than that and they're all 0
+   SquigitCycles cycle_map{};
 
+   ChainOracle() = default;
 
-u32
-squigit(u32 val)
-{
-   u32 ans{0};
+   // assumes lock is held, the bound gets bumped up to at least squigit_bound(3) so 1 and 89 and their chains are always in there
+   SquigitCycles cycles_locked(u32 bound)
+   {
+      if(cycle_map && cycle_map->ids.size() > bound) {
+	 return cycle_map;
+      }
+      cycle_map = std::make_shared<const CycleMap>(find_cycles(std::max(bound, squigit_bound(3)), [](u32 val) { return squigit(val); }));
+      return cycle_map;
+   }
+
+   // assumes lock is held, where the chain starting at val ends up: 1, 89, or 0 for val = 0
+   u32 terminal_locked(u32 val)
+   {
+#ifdef P92_PRODUCTION
+      if(val <= PRODUCTION_BOUND) {
+	 return PRODUCTION_TERMINALS.values[val];
+      }
+#endif
+      // the squigit of any u32 is at most squigit_bound(10), so one step gets anything bigger into the cycle map and it still ends up in the same place
+      const u32 bound = squigit_bound(10);
+      if(val > bound) {
+	 val = squigit(val);
+      }
+      const SquigitCycles map = cycles_locked(bound);
+      if(map->ids[val] == map->ids[1]) {
+	 return 1;
+      }
+      return map->ids[val] == map->ids[89] ? 89 : 0;
+   }
+   
+public:
+   static ChainOracle &instance()
+   {
+      static ChainOracle oracle{};
+      return oracle;
+   }
+
+   // where the chain starting at val ends up, 1 or 89 (or 0 for val = 0)
+   u32 terminal(u32 val)
+   {
+      std::lock_guard<std::mutex> guard{lock};
+      return terminal_locked(val);
+   }
+
+   bool reaches_89(u32 val)
+   {
+      return terminal(val) == 89;
+   }
+
+   // a finished squigits_to_1 for every value from 0 up to at least bound
+   SquigitTable squigits_to_1(u32 bound)
+   {
+      std::lock_guard<std::mutex> guard{lock};
+      if(table && table->size() > bound) {
+	 return table;
+      }
+
+      std::vector<char> ans(bound + 1, false);
+      for(u32 i = 1; i <= bound; ++i) {
+	 ans[i] = (terminal_locked(i) == 1);
+      }
+      table = std::make_shared<const std::vector<char>>(std::move(ans));
+      return table;
+   }
+
+   // the same thing bit-packed, see TerminalBitset
+   SquigitBitset reaches_89_bits(u32 bound)
+   {
+      std::lock_guard<std::mutex> guard{lock};
+      if(bitset && bitset_bound >= bound) {
+	 return bitset;
+      }
+
+      auto ans = std::make_shared<TerminalBitset>(u64{bound} + 1);
+      for(u32 i = 1; i <= bound; ++i) {
+	 if(terminal_locked(i) == 89) {
+	    ans->set(i);
+	 }
+      }
+      bitset = ans;
+      bitset_bound = bound;
+      return bitset;
+   }
+};
+
+
+volatile u64 benchmark_sink{0};
+
+// stores val somewhere the compiler has to assume gets read, so a solve() we're timing can't be optimized away
+inline void do_not_optimize(u128 val)
+{
+   benchmark_sink = static_cast<u64>(val);
+   benchmark_sink = static_cast<u64>(val >> 64);
+}
+
+
+// what Method::benchmark() measured, all the times are in nanoseconds
+struct BenchmarkStats {
+   u128 answer{0};
+   u32 warmup_runs{0};
+   u32 timed_runs{0};
+   double min_ns{0};
+   double median_ns{0};
+   double p95_ns{0};
+   double mean_ns{0};
+   double stddev_ns{0};
+};
+
+
+#ifdef P92_INSTRUMENT
+/*
+The hardware side of the instrumented build, one perf_event_open() counter per event, only counting this process in user space. They're opened with inherit set, so the worker threads the methods start up get counted too (their counts get added in when they exit, and every method joins its threads before solve() returns).
+Most containers and a lot of distros (perf_event_paranoid) don't let a normal user open these, in which case that event just says unavailable and the software counters still work.
+ */
+class PerfCounters {
+private:
+   static const u32 EVENTS{3};
+
+   int fds[EVENTS]{-1, -1, -1};
+
+#ifdef P92_PERF_EVENTS
+   static int open_event(u32 type, u64 config)
+   {
+      perf_event_attr attr{};
+      attr.size = sizeof(attr);
+      attr.type = type;
+      attr.config = config;
+      attr.disabled = 1;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+   }
+#endif
+
+public:
+   static const char *name(u32 event)
+   {
+      static const char *const NAMES[EVENTS]{"cycles", "branch misses", "L1d misses"};
+      return NAMES[event];
+   }
+
+   PerfCounters()
+   {
+#ifdef P92_PERF_EVENTS
+      fds[0] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+      fds[1] = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+      fds[2] = open_event(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+#endif
+   }
+
+   PerfCounters(const PerfCounters &) = delete;
+   PerfCounters &operator=(const PerfCounters &) = delete;
+
+   ~PerfCounters()
+   {
+      for(int fd : fds) {
+	 if(fd >= 0) {
+	    close(fd);
+	 }
+      }
+   }
+
+   void start()
+   {
+#ifdef P92_PERF_EVENTS
+      for(int fd : fds) {
+	 if(fd >= 0) {
+	    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+	    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	 }
+      }
+#endif
+   }
+
+   void stop()
+   {
+#ifdef P92_PERF_EVENTS
+      for(int fd : fds) {
+	 if(fd >= 0) {
+	    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+	 }
+      }
+#endif
+   }
+
+   // false when the event couldn't be opened (or read), and then value is left alone
+   bool read_event(u32 event, u64 &value) const
+   {
+      return fds[event] >= 0 && read(fds[event], &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value));
+   }
+
+   static u32 event_count()
+   {
+      return EVENTS;
+   }
+};
+
+
+// zeroes the counters, runs one solve() and prints what it did on one line, indented under the line print_results() or print_benchmark() printed for it
+class Profiler {
+private:
+   PerfCounters hardware{};
+
+public:
+   template<typename Solve>
+   void profile(Solve &&solve)
+   {
+      instrument_counters.squigit_calls = 0;
+      instrument_counters.cache_hits = 0;
+      instrument_counters.cache_misses = 0;
+      instrument_counters.chain_steps = 0;
+      instrument_counters.allocations = 0;
+
+      hardware.start();
+      do_not_optimize(solve());
+      hardware.stop();
+
+      std::cout << "   profile: squigit calls " << instrument_counters.squigit_calls
+		<< ", cache hits " << instrument_counters.cache_hits
+		<< ", cache misses " << instrument_counters.cache_misses
+		<< ", chain steps " << instrument_counters.chain_steps
+		<< ", allocations " << instrument_counters.allocations;
+      for(u32 event = 0; event < PerfCounters::event_count(); ++event) {
+	 u64 value{0};
+	 std::cout << ", " << PerfCounters::name(event) << ' ';
+	 if(hardware.read_event(event, value)) {
+	    std::cout << value;
+	 } else {
+	    std::cout << "unavailable";
+	 }
+      }
+      std::cout << '\n';
+   }
+};
+#endif
+
+
+// base class
+class Method {   
+private:   
+   virtual u128 solve() const = 0;
+
+public:
+   virtual ~Method() = default;
+
+protected:
+   u32 digits{DEFAULT_DIGITS}; // we count the starting numbers below 10^digits
+
+   Method(u32 num_digits, u32 max_digits)
+      : digits{num_digits}
+   {
+      if(num_digits == 0 || num_digits > max_digits) {
+	 throw std::out_of_range{"digit count must be between 1 and " + std::to_string(max_digits)};
+      }
+   }
+
+   u64 limit() const
+   {
+      return power(10, digits);
+   }
+   
+public:   
+   std::string class_type{};
+
+   u32 digit_count() const
+   {
+      return digits;
+   }
+   
+   void print_results() const
+   {
+      milliseconds time{};
+   
+      auto start = high_resolution_clock::now();
+      u128 ans = solve();
+      auto stop = high_resolution_clock::now();
+
+      time = duration_cast<milliseconds>(stop - start);
+
+      std::cout << class_type << " result below 10^" << digits << ": " << u128_to_string(ans) << ", exection time in ms: " << time.count() << '\n';
+#ifdef P92_INSTRUMENT
+      // a separate run, so counting doesn't get into the time above
+      Profiler{}.profile([this] { return solve(); });
+#endif
+   }
+
+   /*
+   print_results() only times a single run at millisecond resolution, which is fine for the slow methods, but the fast ones finish in a few milliseconds and one run of that is mostly noise. This does warmup_runs untimed runs first (to get the caches and the branch predictor warmed up), then times every one of timed_runs runs in nanoseconds and works out the spread.
+   Every answer goes through do_not_optimize(), and if a run ever gives a different answer than the first one we throw, since that means something is badly broken.
+   */
+   BenchmarkStats benchmark(u32 warmup_runs, u32 timed_runs) const
+   {
+      if(timed_runs == 0) {
+	 throw std::invalid_argument{"a benchmark needs at least one timed run"};
+      }
+      
+      BenchmarkStats stats{};
+      stats.warmup_runs = warmup_runs;
+      stats.timed_runs = timed_runs;
+      
+      for(u32 i = 0; i < warmup_runs; ++i) {
+	 do_not_optimize(solve());
+      }
+
+      std::vector<double> times{};
+      for(u32 i = 0; i < timed_runs; ++i) {
+	 auto start = steady_clock::now();
+	 u128 ans = solve();
+	 auto stop = steady_clock::now();
+	 do_not_optimize(ans);
+
+	 if(i == 0) {
+	    stats.answer = ans;
+	 } else if(ans != stats.answer) {
+	    throw std::runtime_error{class_type + " gave different answers on different runs"};
+	 }
+	 times.push_back(static_cast<double>(duration_cast<nanoseconds>(stop - start).count()));
+      }
+
+      std::sort(times.begin(), times.end());
+      const u32 n = timed_runs;
+      stats.min_ns = times.front();
+      stats.median_ns = n % 2 == 1 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+      stats.p95_ns = times[(95 * n + 99) / 100 - 1]; // nearest rank, ceil(0.95 * n)
+
+      double total{0};
+      for(double t : times) {
+	 total += t;
+      }
+      stats.mean_ns = total / n;
+
+      double squares{0};
+      for(double t : times) {
+	 squares += (t - stats.mean_ns) * (t - stats.mean_ns);
+      }
+      stats.stddev_ns = n > 1 ? std::sqrt(squares / (n - 1)) : 0;
+
+      return stats;
+   }
+
+   void print_benchmark(u32 warmup_runs, u32 timed_runs) const
+   {
+      const BenchmarkStats stats = benchmark(warmup_runs, timed_runs);
+      
+      std::cout << std::fixed << std::setprecision(6);
+      std::cout << class_type << " result below 10^" << digits << ": " << u128_to_string(stats.answer) << ", " << stats.timed_runs << " timed runs (" << stats.warmup_runs << " warm-up) in ms:"
+		<< " min " << stats.min_ns / 1e6
+		<< ", median " << stats.median_ns / 1e6
+		<< ", p95 " << stats.p95_ns / 1e6
+		<< ", stddev " << stats.stddev_ns / 1e6 << '\n';
+      std::cout.unsetf(std::ios::floatfield);
+#ifdef P92_INSTRUMENT
+      // the counts for one run, not all of them added up
+      Profiler{}.profile([this] { return solve(); });
+#endif
+   }
+};
+
+
+/*
+Every Method subclass registers itself in the MethodRegistry right below its class definition (with a static MethodRegistrar), together with what it's able to do, so main() and anything else that wants to go through all the methods don't have to know about each one of them by hand.
+ */
+// the settings a method gets built from, a method just ignores the ones it has no use for
+struct MethodConfig {
+   u32 digits{DEFAULT_DIGITS};
+   SquigitKernel kernel{SquigitKernel::reference};
+   u32 threads{1};
+};
+
+struct MethodCapabilities {
+   u32 max_digits{0}; // the biggest N it can count below 10^N
+   bool multithreaded{false}; // MethodConfig::threads does something
+   bool scans_numbers{false}; // goes through every number, so MethodConfig::kernel does something (and it takes ~10^N work)
+   bool needs_precomputation{false}; // needs a lookup table built outside of solve(), which breaks the rule at the top
+};
+
+typedef std::unique_ptr<Method> (*MethodFactory)(const MethodConfig &config);
+
+struct MethodInfo {
+   std::string name{};
+   MethodCapabilities capabilities{};
+   MethodFactory factory{nullptr};
+};
+
+class MethodRegistry {
+private:
+   std::vector<MethodInfo> registered{};
+
+   MethodRegistry() = default;
+
+public:
+   // a function local static, so it already exists when the first MethodRegistrar runs no matter the order of the static objects
+   static MethodRegistry &instance()
+   {
+      static MethodRegistry registry{};
+      return registry;
+   }
+
+   void add(const MethodInfo &info)
+   {
+      registered.push_back(info);
+   }
+
+   // in the order they were registered, which is the order they're defined in this file, slowest method first
+   const std::vector<MethodInfo> &methods() const
+   {
+      return registered;
+   }
+
+   const MethodInfo &find(const std::string &name) const
+   {
+      for(const MethodInfo &info : registered) {
+	 if(info.name == name) {
+	    return info;
+	 }
+      }
+      throw std::invalid_argument{"unknown method \"" + name + "\", see --list"};
+   }
+
+   // every method that can handle starting numbers below 10^digits
+   std::vector<const MethodInfo *> applicable(u32 digits) const
+   {
+      std::vector<const MethodInfo *> ans{};
+      for(const MethodInfo &info : registered) {
+	 if(digits <= info.capabilities.max_digits) {
+	    ans.push_back(&info);
+	 }
+      }
+      return ans;
+   }
+};
+
+struct MethodRegistrar {
+   explicit MethodRegistrar(const MethodInfo &info)
+   {
+      MethodRegistry::instance().add(info);
+   }
+};
+
+
+// one per worker thread, padded out to a whole cache line so two workers never write to the same line
+struct alignas(64) PaddedCounter {
+   u64 value{0};
+};
+
+
+/*
+Splits [first, last) into blocks of block_size (apart from the last one) and hands them out to threads worker threads, adding up what worker(begin, end) returns for each of them.
+The blocks are handed out through a shared counter instead of one fixed slice per thread, so a thread that got an expensive stretch of numbers doesn't hold everyone else up. Each thread adds its blocks up in its own PaddedCounter and we only add those together at the very end.
+ */
+template<typename Worker>
+u64 parallel_blocks(u64 first, u64 last, u32 threads, u64 block_size, Worker worker)
+{
+   if(threads <= 1) {
+      return worker(first, last);
+   }
+
+   PaddedCounter counters[MAX_THREADS];
+   std::atomic<u64> next_block{first};
+
+   std::vector<std::thread> workers{};
+   for(u32 t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+	 while(true) {
+	    const u64 begin = next_block.fetch_add(block_size);
+	    if(begin >= last) {
+	       break;
+	    }
+	    counters[t].value += worker(begin, std::min(last, begin + block_size));
+	 }
+      });
+   }
+
+   u64 ans{0};
+   for(u32 t = 0; t < threads; ++t) {
+      workers[t].join();
+      ans += counters[t].value;
+   }
+   return ans;
+}
+
+
+// base class for the methods that go through every single starting number, which means they're the ones that care about how fast one squigit is
+class ScanMethod : public Method {
+protected:
+   SquigitKernel kernel{SquigitKernel::reference};
+   u32 threads{1};
+
+   // a thread count of 0 means one thread per core
+   ScanMethod(u32 num_digits, SquigitKernel squigit_kernel, u32 num_threads = 1)
+      : Method{num_digits, MAX_SCAN_DIGITS}, kernel{squigit_kernel}, threads{num_threads}
+   {
+      if(threads == 0) {
+	 threads = std::max(std::thread::hardware_concurrency(), 1u);
+      }
+      threads = std::min(threads, MAX_THREADS);
+   }
+
+   // see parallel_blocks(), worker(begin, end) has to return how many numbers in [begin, end) go to 89 and must only read shared data
+   template<typename Worker>
+   u64 parallel_count(u64 first, u64 last, Worker worker) const
+   {
+      return parallel_blocks(first, last, threads, std::max<u64>((last - first) / (u64{threads} * 16), 1 << 16), worker);
+   }
+
+   // for following a chain after the first squigit, these values are all small so the chunked kernel only needs one lookup here, the odometer doesn't help since chains jump all over the place
+   u32 chain_squigit(u32 val) const
+   {
+      P92_COUNT(squigit_calls);
+      P92_COUNT(chain_steps);
+      return kernel == SquigitKernel::chunked || kernel == SquigitKernel::blocked ? squigit_chunked(val) : squigit(val);
+   }
+
+   // appended to class_type so the non-reference kernels and thread counts show up separately in the results
+   std::string variant_suffix() const
+   {
+      std::string suffix{};
+      switch(kernel) {
+      case SquigitKernel::chunked:
+	 suffix = std::string{"_chunked"};
+	 break;
+      case SquigitKernel::incremental:
+	 suffix = std::string{"_incremental"};
+	 break;
+      case SquigitKernel::blocked:
+	 suffix = std::string{"_blocked"};
+	 break;
+      default:
+	 break;
+      }
+      if(threads > 1) {
+	 suffix += "_" + std::to_string(threads) + "_threads";
+      }
+      return suffix;
+   }
+};
+
+
+// this is the most naive and brute-force approach, it simply loops through all ten million numbers and then checks to see if it reaches 89, and if it does, it increments a counter.
+class BruteForceMethod : public ScanMethod {
+private:
+   u128 solve() const {
+      return parallel_count(1, limit(), [this](u64 first, u64 last) {
+	 return count_range(first, last);
+      });
+   }
+
+   u64 count_range(u64 first, u64 last) const {
+      u64 numbers_ending_with_89{0};
+   
+      for_each_squigit(first, last, kernel, [&](u32 val) {
+	 u32 chain_length{0};
+	 while(true) {
+	    if(val == 89) {
+	       ++numbers_ending_with_89;
+	       break;
+	    } else if(val == 1) {
+	       break;
+	    } else {
+	       val = chain_squigit(val);
+	    }
+
+	    ++chain_length;
+	 }
+
+	 
+	 // I wanted to see how long a chain was, meaning how many numbers after a given starting number does it take to get to 89 or 1, apparently it's under 12 because this statement doesn't execute at all for all 9999999 numbers we check - uncomment the next line so this code can run.
+	 // #define TEST_CHAIN
+	 #ifdef TEST_CHAIN
+	 if(chain_length >= 12) {
+	    std::cout << "chain length: " << chain_length << "\n";
+	 }
+	 #endif
+      });
+
+      return numbers_ending_with_89;
+   }
+
+public:
+   BruteForceMethod(u32 num_digits = DEFAULT_DIGITS, SquigitKernel squigit_kernel = SquigitKernel::reference, u32 num_threads = 1)
+      : ScanMethod{num_digits, squigit_kernel, num_threads}
+   {
+      class_type = std::string{"brute_force_method"} + variant_suffix();
+   }
+};
+const MethodRegistrar brute_force_method_registrar{{"brute_force_method", {MAX_SCAN_DIGITS, true, true, false}, [](const MethodConfig &config) -> std::unique_ptr<Method> {
+   return std::make_unique<BruteForceMethod>(config.digits, config.kernel, config.threads);
+}}};
+
+
+// This is similar to the above method, but it also makes use of a cache that is updated every loop iteration to include numbers that we know will reach 89, which speeds things up a bit.
+class BruteForceMethodCached : public ScanMethod {
+private:
+   // chains under ten million are at most 12 long, and since the cache is only there to speed things up, if a chain ever gets longer than this we just don't cache the rest of it
+   static const u32 CHAIN_BUFFER_SIZE{16};
+   
+   u128 solve() const
+   {
+      // every squigit we can come across is at most squigit_bound(digits), so that's all the cache needs to cover
+      const u32 cache_size = squigit_bound(digits) + 1;
+      std::vector<char> numbers_that_goto_89(cache_size, false);
+      std::vector<char> numbers_that_goto_1(cache_size, false);
+      
+      u64 numbers_ending_with_89{0};
+   
+      for_each_squigit(1, limit(), kernel, [&](u32 val) {
+	 
+	 // if this chain ends in 89, we will cache all these numbers in numbers_that_goto_89, otherwise if they go to 1 they go in numbers_that_goto_1. This used to be a std::vector, but making a new one for every starting number meant a malloc and a free per number, which ended up costing more than the caching saved
+	 u32 chain_numbers[CHAIN_BUFFER_SIZE];
+	 u32 chain_length{0};
+	 bool goes_to_1{false};
+
+	 while(true) {
+	    if(val == 89 || numbers_that_goto_89[val]) {
+	       P92_COUNT_BY(cache_hits, val != 89); // 89 itself never gets looked up in the cache
+	       ++numbers_ending_with_89;
+	       break;
+	    } else if(val == 1 || numbers_that_goto_1[val]) {
+	       P92_COUNT_BY(cache_hits, val != 1);
+	       goes_to_1 = true;
+	       break;
+	    } else {
+	       P92_COUNT(cache_misses);
+	       if(chain_length < CHAIN_BUFFER_SIZE) {
+		  chain_numbers[chain_length++] = val;
+	       }
+	       val = chain_squigit(val);
+	    }
+	 }
+
+	 if(goes_to_1) {
+	    for(u32 i = 0; i < chain_length; ++i) {
+	       numbers_that_goto_1[chain_numbers[i]] = true;
+	    }
+	 } else {
+	    for(u32 i = 0; i < chain_length; ++i) {
+	       numbers_that_goto_89[chain_numbers[i]] = true;
+	    }
+	 }
+      });
+
+      // std::cout << numbers_that_goto_89.size() << '\n';
+
+      return numbers_ending_with_89;
+   }
+public:
+   BruteForceMethodCached(u32 num_digits = DEFAULT_DIGITS, SquigitKernel squigit_kernel = SquigitKernel::reference)
+      : ScanMethod{num_digits, squigit_kernel}
+   {
+      class_type = std::string{"brute_force_method_cached"} + variant_suffix();
+   }
+};
+const MethodRegistrar brute_force_method_cached_registrar{{"brute_force_method_cached", {MAX_SCAN_DIGITS, false, true, false}, [](const MethodConfig &config) -> std::unique_ptr<Method> {
+   return std::make_unique<BruteForceMethodCached>(config.digits, config.kernel);
+}}};
+
+
+/*
+This method is similar to BruteForceMethodCached, but it creates the cache of numbers beforehand using the trick that all the possible squigits of 1 to 9999999 is 9^2 * 7 = 567 (and 9^2 * N for N digits, see squigit_bound()), so we only need to check 567 values which is pretty small, and then we can cache the result immediately and then just loop through all ten million values - it's prety much the same as BruteForcedMethodCached but slightly different - and it turns out that it helps speed things up a little bit, possibly because we aren't constantly adding to a cache each loop iteration, but just perfoming a simple lookup with the index of the number we want to check.
+(These days the squigit cache is the shared one from ChainOracle, so it only ever gets built once no matter how many methods use it.)
+ */
+class SquigitsMethod : public ScanMethod {
+private:
+   
+   u128 solve() const
+   {
+      const SquigitTable table = ChainOracle::instance().squigits_to_1(squigit_bound(digits));
+      const std::vector<char> &squigits_to_1 = *table; // since there are much less squigits that go to 1, we simply only keep track of these, and if a number's squigit is NOT in here, then it goes to 89, so it should be fast to check this small array. (char and not bool so we don't get the bit-packed std::vector<bool> in the hot loop)
+
+      // squigits_to_1 is only ever read, so every worker shares the one copy
+      return parallel_count(1, limit(), [&](u64 first, u64 last) {
+	 u64 ans{0};
+	 for_each_squigit(first, last, kernel, [&](u32 val) {
+	    if(!squigits_to_1[val]) {
+	       ++ans;
+	    }
+	 });
+	 return ans;
+      });
+   }
+   
+public:
+   
+   SquigitsMethod(u32 num_digits = DEFAULT_DIGITS, SquigitKernel squigit_kernel = SquigitKernel::reference, u32 num_threads = 1)
+      : ScanMethod{num_digits, squigit_kernel, num_threads}
+   {
+      class_type = std::string{"squigits_method"} + variant_suffix();
+   }
+};
+const MethodRegistrar squigits_method_registrar{{"squigits_method", {MAX_SCAN_DIGITS, true, true, false}, [](const MethodConfig &config) -> std::unique_ptr<Method> {
+   return std::make_unique<SquigitsMethod>(config.digits, config.kernel, config.threads);
+}}};
+
+
+/*
+This is SquigitsMethod again, but instead of one squigit at a time we do SIMD_BATCH consecutive numbers at once with squigit_batch_kernel(), which works out the last 4 digits of all 16 of them in parallel in 16 bit lanes (AVX2 on x86, NEON on ARM, plain loop everywhere else, picked at runtime), and then we look every one up in the bit-packed version of squigits_to_1 (TerminalBitset). With AVX2 the lookups happen in the vectors too (count_89_batch()), 8 at a time with a gather, a shift and a mask, and no branches anywhere.
+The batches have to start at a multiple of 16, so the few numbers before the first one and after the last one go through the chunked kernel.
+ */
+class SimdSquigitsMethod : public ScanMethod {
+private:
+
+   u128 solve() const
+   {
+      const SquigitBitset bits = ChainOracle::instance().reaches_89_bits(squigit_bound(digits));
+      const TerminalBitset &reaches_89 = *bits;
+
+      const Count89BatchFn count_batch = count_89_batch_kernel();
+      
+      return parallel_count(1, limit(), [&](u64 first, u64 last) {
+	 u64 ans{0};
+	 auto count_89 = [&](u32 val) {
+	    ans += reaches_89.reaches_89(val);
+	 };
+
+	 u64 i = std::min(last, (first + SIMD_BATCH - 1) / SIMD_BATCH * SIMD_BATCH);
+	 for_each_squigit(first, i, kernel, count_89);
+	 
+	 const u16 *chunks = chunk_squigits();
+	 u32 high_squigit = squigit_chunked(i / CHUNK_SIZE, chunks);
+	 for(; i + SIMD_BATCH <= last; i += SIMD_BATCH) {
+	    const u32 low = static_cast<u32>(i % CHUNK_SIZE);
+	    if(low == 0) {
+	       high_squigit = squigit_chunked(i / CHUNK_SIZE, chunks); // only changes once every 625 batches
+	    }
+	    P92_COUNT_BY(squigit_calls, SIMD_BATCH);
+	    ans += count_batch(high_squigit, low, reaches_89);
+	 }
+	 
+	 for_each_squigit(i, last, kernel, count_89);
+	 return ans;
+      });
+   }
+
+public:
+   SimdSquigitsMethod(u32 num_digits = DEFAULT_DIGITS, u32 num_threads = 1)
+      : ScanMethod{num_digits, SquigitKernel::chunked, num_threads}
+   {
+      class_type = std::string{"simd_squigits_method_"} + squigit_batch_isa() + (threads > 1 ? "_" + std::to_string(threads) + "_threads" : std::string{});
+   }
+};
+const MethodRegistrar simd_squigits_method_registrar{{"simd_squigits_method", {MAX_SCAN_DIGITS, true, true, true}, [](const MethodConfig &config) -> std::unique_ptr<Method> {
+   return std::make_unique<SimdSquigitsMethod>(config.digits, config.threads);
+}}};
+
+
+/*
+Calls f(counts, squigit, permutations) once for every multiset of `digits` digits (so every combination with repetition of 0-9), where counts[d] is how many times digit d shows up, squigit is the squigit of those digits and permutations is how many distinct strings of `digits` digits they make, the multinomial digits! / (counts[0]! * ... * counts[9]!).
+It works like an odometer on the counts: counts[0..8] are picked one after the other out of what's left and digit 9 takes the rest. Picking c copies of digit d out of r digits left multiplies the permutations by (r choose c), so for every level we keep what's left, the squigit and the permutations so far, and when a count goes up by one only that level and the ones after it have to change. (r choose c) comes from (r choose c - 1) * (r - c + 1) / c, which always divides exactly, and mul_div_exact() does it without ever going past the result, so it's exact all the way up to 38 digits and throws instead of wrapping around if a count doesn't fit in a u128.
+No recursion and nothing gets allocated, the only state is the handful of arrays below.
+With a prefix, the counts of the first prefix_levels digits are fixed to prefix[0..prefix_levels - 1] and only the multisets that start with them get walked, which is how ParallelDigitsMethod cuts the walk up into tasks. The prefix can't add up to more than digits.
+ */
+template<typename F>
+void for_each_digit_multiset(u32 digits, const u32 *prefix, u32 prefix_levels, F &&f)
+{
+   u32 counts[10]{};
+   u32 remaining[10]{}; // remaining[d] is how many digits are left to hand out to d, d + 1, ..., 9
+   u32 squigits[10]{}; // squigit of the digits below d
+   u128 permutations[10]{}; // permutations of the digits below d into their spots, i.e. the product of the (r choose c) for each level below d
+
+   remaining[0] = digits;
+   for(u32 k = 0; k < 10; ++k) {
+      permutations[k] = 1; // every count starts at 0 and (r choose 0) = 1
+   }
+   for(u32 k = 0; k < prefix_levels; ++k) {
+      counts[k] = prefix[k];
+      remaining[k + 1] = remaining[k] - counts[k];
+      squigits[k + 1] = squigits[k] + counts[k] * k * k;
+      u128 fixed{permutations[k]};
+      for(u32 c = 1; c <= counts[k]; ++c) {
+	 fixed = mul_div_exact(fixed, remaining[k] - c + 1, c);
+      }
+      for(u32 j = k + 1; j < 10; ++j) {
+	 permutations[j] = fixed;
+      }
+   }
+   
+   u32 d{prefix_levels};
+   while(true) {
+      // fill in every level from d onwards, every one after d starts at 0 again
+      for(; d < 9; ++d) {
+	 remaining[d + 1] = remaining[d] - counts[d];
+	 squigits[d + 1] = squigits[d] + counts[d] * d * d;
+	 if(d < 8) {
+	    counts[d + 1] = 0;
+	 }
+      }
+      counts[9] = remaining[9];
+      
+      f(static_cast<const u32 *>(counts), squigits[9] + 81 * counts[9], permutations[9]);
+
+      // find the last level we can still bump up, all the levels after it were already at 0 when they started so the permutations only change from there on
+      u32 level{9};
+      while(level > prefix_levels && counts[level - 1] == remaining[level - 1]) {
+	 --level;
+      }
+      if(level == prefix_levels) {
+	 return;
+      }
+      d = level - 1;
+      ++counts[d];
+#ifdef P92_PRODUCTION
+      permutations[d + 1] = permutations[d] * PRODUCTION_BINOMIALS.values[remaining[d]][counts[d]];
+#else
+      permutations[d + 1] = mul_div_exact(permutations[d + 1], remaining[d] - counts[d] + 1, counts[d]);
+#endif
+      // the permutations of the levels after d start over from permutations[d + 1] since they're all back to a count of 0, (r choose 0) = 1
+      for(u32 k = d + 2; k <= 9; ++k) {
+	 permutations[k] = permutations[d + 1];
+      }
+   }
+}
+
+template<typename F>
+void for_each_digit_multiset(u32 digits, F &&f)
+{
+   for_each_digit_multiset(digits, nullptr, 0, std::forward<F>(f));
+}
+
+
+/*
+All the other methods have been ignoring the fact that several combinations of numbers produce the same squigit, such as: [10, 1000, 1000], or [57, 705, 7005, 5007]
+We can exploit this by enumerating all possible combinations and then checking to see if a given combination reaches 89 eventually, the trick will be to figure out how many starting numbers a given combination corresponds to. We also need to figure out how to enumerate all possible combinations, NOT permutations, which should shrink how many iterations our main loop will be by a large percentage.
+
+Inspired from the recursive method described here: "https://stackoverflow.com/questions/12991758/creating-all-possible-k-combinations-of-n-items-in-c", we generate all combinations and then iterate over them, which turns out to be 11440 combinations! 11440 is much less than 10,000,000 to loop over - and then with each combination we compute to see if it goes to 89 using the squigit method, and then if it does, we generate the permutations from this combination which gives us how many starting numbers this combination permutates to.
+
+Once we have all combinations, we'll need to then figure out if it runs to 89 (that's easy, we'll use the squigits method), and then we'll need to figure out how many permutations we can make from these combinations
+We don't have a clean permutation formula because repeated contiguous elements are indistinguishable, such as 1111. It doesn't matter what order those 1's are in, it equals the same. But using this post on math stack exchange: "https://math.stackexchange.com/questions/2005441/possible-numbers-from-given-numbers-using-permutations-and-combinaitions", I figured out how to calulate the permutations using the "rule of product", and with this we have our DigitsMethod which is the fastest and most efficient I was able to come up with.
+
+Building every combination up front with the recursive combination() turned out to cost way more than the counting itself though, since it passed vectors around by value and made a new vector for every one of the combinations (tens of thousands of allocations for 7 digits, and it only gets worse for more). So now the combinations are walked in place by for_each_digit_multiset() below, which also keeps the squigit and the permutation count up to date as it goes instead of working them out from scratch for every combination.
+ */
+class DigitsMethod : public Method {
+   
+private:
+   
+   u128 solve() const
+   {
+      const SquigitTable table = ChainOracle::instance().squigits_to_1(squigit_bound(digits));
+      const std::vector<char> &squigits_to_1 = *table;
+
+      u128 ans{0};
+      
+      // if we get a combination running to 89, we add all the starting numbers it permutates to, also we're checking to see if squigit_val is not 0 because if it is it's the all zeros combination, which is just the number 0 and would be a bug
+      for_each_digit_multiset(digits, [&](const u32 *, u32 squigit_val, u128 starting_numbers) {
+	 if(squigit_val != 0 && !squigits_to_1[squigit_val]) {
+	    ans += starting_numbers;
+	 }
+      });
+      
+      return ans;
+   }
+public:
+   // the permutation counts are exact u128s (see mul_div_exact()), so this goes as far as the answer fits, but the number of combinations is (N + 9 choose 9) so 38 digits means walking about 1.4 billion of them
+   DigitsMethod(u32 num_digits = DEFAULT_DIGITS)
+      : Method{num_digits, MAX_COUNT_DIGITS}
+   {
+      class_type = std::string{"digits_method"};
+   }
+};
+const MethodRegistrar digits_method_registrar{{"digits_method", {MAX_COUNT_DIGITS, false, false, false}, [](const MethodConfig &config) -> std::unique_ptr<Method> {
+   return std::make_unique<DigitsMethod>(config.digits);
+}}};
+
+
+/*
+DigitsMethod spread over several threads. Splitting the multisets up by their first digit alone is hopeless, the ones with no zeroes at all are (N + 8 choose 8) out of (N + 9 choose 9) so one thread ends up with most of the work. Instead every task is a prefix of the counts, how many 0s, 1s and 2s there are, which makes (N + 3 choose 3) tasks where even the biggest one is well under 1% of the walk for the big N.
+The tasks are still nothing like the same size, so every worker starts off with its own even slice of the task list and takes tasks off the front of it, and once it runs out it steals the back half of what somebody else has left. Each worker only locks its own slice apart from when it's stealing, and adds up its answer in its own u128 until the very end.
+ */
+class ParallelDigitsMethod : public Method {
+private:
+   static const u32 PREFIX_LEVELS{3};
+   
+   u32 threads{1};
+
+   struct Prefix {
+      u32 counts[PREFIX_LEVELS];
+   };
+
+   struct alignas(64) Worker {
+      std::mutex lock{};
+      u32 next{0}; // the tasks still to do are next..end - 1
+      u32 end{0};
+      u128 total{0};
+   };
+
+   // takes the back half of somebody else's tasks (or their last one) out of workers[0..count - 1], returns false if everyone's out
+   static bool steal(Worker *workers, u32 count, u32 thief)
+   {
+      for(u32 i = 1; i < count; ++i) {
+	 Worker &victim = workers[(thief + i) % count];
+	 u32 begin{0};
+	 u32 end{0};
+	 {
+	    std::lock_guard<std::mutex> guard{victim.lock};
+	    if(victim.next == victim.end) {
+	       continue;
+	    }
+	    begin = victim.next + (victim.end - victim.next) / 2;
+	    end = victim.end;
+	    victim.end = begin;
+	 }
+	 std::lock_guard<std::mutex> guard{workers[thief].lock};
+	 workers[thief].next = begin;
+	 workers[thief].end = end;
+	 return true;
+      }
+      return false;
+   }
+
+   u128 solve() const
+   {
+      const SquigitTable table = ChainOracle::instance().squigits_to_1(squigit_bound(digits));
+      const std::vector<char> &squigits_to_1 = *table;
+
+      std::vector<Prefix> tasks{};
+      for(u32 a = 0; a <= digits; ++a) {
+	 for(u32 b = 0; a + b <= digits; ++b) {
+	    for(u32 c = 0; a + b + c <= digits; ++c) {
+	       tasks.push_back(Prefix{{a, b, c}});
+	    }
+	 }
+      }
+
+      const u32 worker_count = std::min<u32>(threads, static_cast<u32>(tasks.size()));
+      Worker workers[MAX_THREADS]; // a plain array like parallel_blocks() does it, since in C++14 std::vector's allocator ignores the alignas and two workers could end up on the same cache line
+      for(u32 t = 0; t < worker_count; ++t) {
+	 workers[t].next = static_cast<u32>(tasks.size() * t / worker_count);
+	 workers[t].end = static_cast<u32>(tasks.size() * (t + 1) / worker_count);
+      }
+
+      auto work = [&](u32 t) {
+	 Worker &self = workers[t];
+	 u128 total{0};
+	 while(true) {
+	    u32 task{0};
+	    bool found{false};
+	    {
+	       std::lock_guard<std::mutex> guard{self.lock};
+	       if(self.next != self.end) {
+		  task = self.next++;
+		  found = true;
+	       }
+	    }
+	    if(!found) {
+	       if(!steal(workers, worker_count, t)) {
+		  break;
+	       }
+	       continue;
+	    }
+	    
+	    for_each_digit_multiset(digits, tasks[task].counts, PREFIX_LEVELS, [&](const u32 *, u32 squigit_val, u128 starting_numbers) {
+	       if(squigit_val != 0 && !squigits_to_1[squigit_val]) {
+		  total += starting_numbers;
+	       }
+	    });
+	 }
+	 self.total = total;
+      };
+
+      std::vector<std::thread> pool{};
+      for(u32 t = 1; t < worker_count; ++t) {
+	 pool.emplace_back(work, t);
+      }
+      work(0);
+      
+      u128 ans{workers[0].total};
+      for(u32 t = 1; t < worker_count; ++t) {
+	 pool[t - 1].join();
+	 ans += workers[t].total;
+      }
+      return ans;
+   }
+
+public:
+   // a thread count of 0 means one thread per core
+   ParallelDigitsMethod(u32 num_digits = DEFAULT_DIGITS, u32 num_threads = 1)
+      : Method{num_digits, MAX_COUNT_DIGITS}, threads{num_threads}
+   {
+      if(threads == 0) {
+	 threads = std::max(std::thread::hardware_concurrency(), 1u);
+      }
+      threads = std::min(threads, MAX_THREADS);
+      class_type = std::string{"parallel_digits_method"} + (threads > 1 ? "_" + std::to_string(threads) + "_threads" : "");
+   }
+};
+const MethodRegistrar parallel_digits_method_registrar{{"parallel_digits_method", {MAX_COUNT_DIGITS, true, false, false}, [](const MethodConfig &config) -> std::unique_ptr<Method> {
+   return std::make_unique<ParallelDigitsMethod>(config.digits, config.threads);
+}}};
+
+
+/*
+DigitsMethod still has to walk every combination of N digits, and there are (N + 9 choose 9) of those, which blows up pretty fast as N grows. But we never actually care which digits a number has, only what its squigit is, so instead we can just count how many N digit strings (leading zeros allowed, so this covers every number below 10^N) there are for each squigit value.
+If count[s] is how many (n - 1) digit strings have squigit s, then tacking one more digit d on the front gives squigit s + d^2, so the new count[s] is just the sum of the old count[s - d^2] for d = 0..9. If we walk s from the top down we can do that in place in a single array, since every count[s - d^2] we read is below s and hasn't been updated yet.
+That is N passes over at most 81 * N squigits, so it's O(N * 81N) work in total which is tiny, and afterwards we just add up count[s] for every squigit s that goes to 89 (skipping s = 0, which is only the number 0 itself).
+ */
+class DigitSumDPMethod : public Method {
+private:
+
+   u128 solve() const
+   {
+      const SquigitTable table = ChainOracle::instance().squigits_to_1(squigit_bound(digits));
+      const std::vector<char> &squigits_to_1 = *table;
+
+      std::vector<u128> count(81 * digits + 1, 0);
+      count[0] = 1; // there's exactly one 0 digit string and its squigit is 0
+      
+      for(u32 n = 1; n <= digits; ++n) {
+	 for(u32 s = 81 * n; s > 0; --s) {
+	    for(u32 d = 1; d <= 9 && d * d <= s; ++d) {
+	       count[s] += count[s - d * d];
+	    }
+	 }
+      }
+
+      u128 ans{0};
+      for(u32 s = 1; s <= 81 * digits; ++s) {
+	 if(!squigits_to_1[s]) {
+	    ans += count[s];
+	 }
+      }
+
+      return ans;
+   }
+   
+public:
+   // the counts are u128, so 10^38 is as far as we can go before the answer itself overflows
+   DigitSumDPMethod(u32 num_digits = DEFAULT_DIGITS)
+      : Method{num_digits, MAX_COUNT_DIGITS}
+   {
+      class_type = std::string{"digit_sum_dp_method"};
+   }
+};
+const MethodRegistrar digit_sum_dp_method_registrar{{"digit_sum_dp_method", {MAX_COUNT_DIGITS, false, false, false}, [](const MethodConfig &config) -> std::unique_ptr<Method> {
+   return std::make_unique<DigitSumDPMethod>(config.digits);
+}}};
+
+
+/*
+Every multiset of `digits` digits, grouped by squigit the way a CSR sparse matrix groups its rows: the multisets with a squigit of s are multisets[offsets[s]] up to multisets[offsets[s + 1]]. Each one is packed into a u64 with 6 bits per digit count (a count never goes past 38), and counts[s] is how many numbers in [1, 10^digits) have a squigit of s, so that part of a query is just a lookup.
+It takes two passes of for_each_digit_multiset(), one to count how many multisets each squigit gets and one to put them in place.
+ */
+class MultisetIndex {
+private:
+   static const u32 BITS_PER_DIGIT{6};
+   
+   u32 digits{0};
+   std::vector<u32> offsets{};
+   std::vector<u64> multisets{};
+   std::vector<u128> counts{};
+
+public:
+   explicit MultisetIndex(u32 num_digits)
+      : digits{num_digits}, offsets(81 * num_digits + 2, 0), counts(81 * num_digits + 1, 0)
+   {
+      for_each_digit_multiset(digits, [this](const u32 *, u32 squigit, u128 permutations) {
+	 if(squigit != 0) { // that's only the all zeroes one, which is the number 0
+	    ++offsets[squigit + 1];
+	    counts[squigit] += permutations;
+	 }
+      });
+      for(u32 s = 1; s < offsets.size(); ++s) {
+	 offsets[s] += offsets[s - 1];
+      }
+
+      multisets.resize(offsets.back());
+      std::vector<u32> next(offsets.begin(), offsets.end() - 1);
+      for_each_digit_multiset(digits, [this, &next](const u32 *digit_counts, u32 squigit, u128) {
+	 if(squigit != 0) {
+	    u64 packed{0};
+	    for(u32 d = 0; d < 10; ++d) {
+	       packed |= u64{digit_counts[d]} << (BITS_PER_DIGIT * d);
+	    }
+	    multisets[next[squigit]++] = packed;
+	 }
+      });
+   }
+
+   // how many numbers in [1, 10^digits) have a squigit of s
+   u128 count(u32 s) const
+   {
+      return s < counts.size() ? counts[s] : 0;
+   }
+
+   // calls f(digit_counts, permutations) for every multiset with a squigit of s, digit_counts[d] being how many of digit d it has
+   template<typename F>
+   void for_each(u32 s, F &&f) const
+   {
+      if(s >= counts.size()) {
+	 return;
+      }
+      for(u32 i = offsets[s]; i < offsets[s + 1]; ++i) {
+	 u32 digit_counts[10];
+	 for(u32 d = 0; d < 10; ++d) {
+	    digit_counts[d] = static_cast<u32>(multisets[i] >> (BITS_PER_DIGIT * d)) & ((1u << BITS_PER_DIGIT) - 1);
+	 }
+	 f(static_cast<const u32 *>(digit_counts), multinomial(digit_counts, 10));
+      }
+   }
+};
+
+
+/*
+My old inverse squigit tree idea from THINGS I LEARNED in main(), which fell apart because it was trying to go backwards from 89 to the starting numbers themselves. It works if we only go backwards over the small values (up to squigit_bound(), where the chains live after their first step anyway) and let the MultisetIndex do the very last step back to the starting numbers.
+So the tree is every value up to the bound with an edge back from squigit(v) to v, and a breadth first search from a target, one level at a time, finds everything whose chain goes through that target. The numbers below 10^N whose chain goes through it are then exactly the ones whose squigit is in there, and the index already knows how many numbers have each squigit.
+ */
+class ReverseTree {
+private:
+   MultisetIndex index;
+   std::vector<std::vector<u32>> predecessors{}; // predecessors[x] = the values up to the bound whose squigit is x
+
+public:
+   explicit ReverseTree(u32 digits)
+      : index{digits}, predecessors(squigit_bound(digits) + 1)
+   {
+      for(u32 v = 1; v < predecessors.size(); ++v) {
+	 predecessors[squigit(v)].push_back(v);
+      }
+   }
+
+   const MultisetIndex &multisets() const
+   {
+      return index;
+   }
+
+   // levels[k] = the values up to the bound that get to target in exactly k steps (and not fewer), levels[0] being just the target
+   std::vector<std::vector<u32>> levels(u32 target) const
+   {
+      if(target == 0 || target >= predecessors.size()) {
+	 throw std::out_of_range{"target has to be between 1 and " + std::to_string(predecessors.size() - 1)};
+      }
+      
+      std::vector<char> seen(predecessors.size(), false);
+      std::vector<std::vector<u32>> ans{{target}};
+      seen[target] = true;
+      while(true) {
+	 std::vector<u32> next{};
+	 for(u32 x : ans.back()) {
+	    for(u32 v : predecessors[x]) {
+	       if(!seen[v]) {
+		  seen[v] = true;
+		  next.push_back(v);
+	       }
+	    }
+	 }
+	 if(next.empty()) {
+	    return ans;
+	 }
+	 std::sort(next.begin(), next.end());
+	 ans.push_back(next);
+      }
+   }
+
+   // how many numbers below 10^N have the target as their squigit
+   u128 count_landing_on(u32 target) const
+   {
+      return index.count(target);
+   }
+
+   // how many numbers below 10^N have the target somewhere in their chain after the starting number itself
+   u128 count_reaching(u32 target) const
+   {
+      u128 ans{0};
+      for(const std::vector<u32> &level : levels(target)) {
+	 for(u32 v : level) {
+	    ans += index.count(v);
+	 }
+      }
+      return ans;
+   }
+};
+
+
+class ReverseTreeMethod : public Method {
+private:
+   u128 solve() const
+   {
+      const ReverseTree tree{digits};
+      const u128 ans = tree.count_reaching(89);
+      // every starting number's chain goes through exactly one of them, so growing the tree from 1 as well is a free check that neither one missed anything
+      if(ans + tree.count_reaching(1) != u128{limit()} - 1) {
+	 throw std::logic_error{"the trees from 1 and 89 don't cover every starting number below 10^" + std::to_string(digits)};
+      }
+      return ans;
+   }
+
+public:
+   // the index keeps every multiset around, at 10^19 that's 7 million of them (55MB) so this is no place for 38 digits
+   ReverseTreeMethod(u32 num_digits = DEFAULT_DIGITS)
+      : Method{num_digits, MAX_SCAN_DIGITS}
+   {
+      class_type = std::string{"reverse_tree_method"};
+   }
+};
+const MethodRegistrar reverse_tree_method_registrar{{"reverse_tree_method", {MAX_SCAN_DIGITS, false, false, false}, [](const MethodConfig &config) -> std::unique_ptr<Method> {
+   return std::make_unique<ReverseTreeMethod>(config.digits);
+}}};
+
+
+/*
+Everything we can say about the chains of the starting numbers below 10^N, not just how many of them end at 89. It's the same trick as DigitSumDPMethod: every number with the same squigit has the same chain after its first step, so a squigit s that shows up count[s] times gives count[s] chains that are 1 longer than the chain of s itself, and we never have to touch the numbers.
+A chain length here counts the starting number and everything up to and including the first 1 or 89, so 44 -> 32 -> 13 -> 10 -> 1 is 5 long and 1 and 89 are chains of 1 on their own.
+ */
+struct ChainStats {
+   u32 digits{DEFAULT_DIGITS};
+   u128 reaching_1{0};
+   u128 reaching_89{0};
+   std::vector<u128> lengths_to_1{}; // lengths_to_1[L] = how many starting numbers get to 1 in a chain L long
+   std::vector<u128> lengths_to_89{}; // and the same for 89
+   u32 longest_chain{0};
+   u128 longest_chain_count{0}; // how many starting numbers have a chain that long
+   std::vector<u128> longest_chain_example{}; // the whole chain of the smallest of them
+};
+
+ChainStats chain_stats(u32 digits);
+
+
+/*
+How many numbers in [from, to) end up at 89, for any from and to up to 10^38 instead of just 1 to 10^N. It's a digit DP over the decimal digits of the bound: going left to right, for every position where we put a digit smaller than the bound's digit there, every possible tail is below the bound, and how many of those tails bring the whole number to 89 only depends on the squigit of what we've fixed so far and the squigit distribution of the free digits after it. So each bound costs (its digits) * 9 * (81 * its digits), no matter how far apart from and to are.
+The distributions and the terminals get built once for 38 digits in the constructor, so one of these can answer as many queries as we want.
+ */
+class RangeCounter {
+private:
+   std::vector<std::vector<u128>> distributions{};
+   SquigitBitset reaches_89{};
+
+public:
+   RangeCounter()
+      : distributions{squigit_distributions(MAX_COUNT_DIGITS)},
+	reaches_89{ChainOracle::instance().reaches_89_bits(squigit_bound(MAX_COUNT_DIGITS))}
+   {
+   }
+
+   // how many numbers in [1, bound) reach 89, for bound <= 10^38
+   u128 count_below(u128 bound) const
+   {
+      const std::string text = u128_to_string(bound);
+      const TerminalBitset &bits = *reaches_89;
+      u128 ans{0};
+      u32 head{0}; // squigit of the digits of bound we've kept so far
+      
+      for(u32 i = 0; i < text.size(); ++i) {
+	 const u32 digit = static_cast<u32>(text[i] - '0');
+	 const u32 free = static_cast<u32>(text.size()) - 1 - i;
+	 const std::vector<u128> &tails = distributions[free];
+	 for(u32 d = 0; d < digit; ++d) {
+	    for(u32 s = 0; s <= 81 * free; ++s) {
+	       ans += tails[s] * bits.reaches_89(head + d * d + s); // 0 never reaches 89, so the zero itself doesn't get counted
+	    }
+	 }
+	 head += digit * digit;
+      }
+      
+      return ans;
+   }
+
+   u128 count(u128 from, u128 to) const
+   {
+      if(from > to) {
+	 throw std::invalid_argument{"range [" + u128_to_string(from) + ", " + u128_to_string(to) + ") is backwards"};
+      }
+      return count_below(to) - count_below(from);
+   }
+};
+
+
+struct RangeQuery {
+   u128 from{0};
+   u128 to{0};
+};
+
+
+/*
+The squigit is just one member of a family: add up the Exponent-th powers of the base Base digits instead of the squares of the decimal ones, and the chains still always end in a cycle (these are what the happy number people play with). The difference is that the cycles aren't 1 and 89 any more, sums of cubes in base 10 for example have 153, 370, 371, 407 and a few loops of 2 and 3 numbers.
+So DigitPowerFamily<Base, Exponent> is the whole DigitSumDPMethod engine for one of them: its own digit power table worked out by the compiler, its own bound, find_cycles() over everything up to that bound, and the count of how many starting numbers below Base^N end up in each cycle. DigitPowerFamily<10, 2> is our problem.
+ */
+template<u32 Base>
+struct DigitPowers {
+   u32 values[Base];
+};
+
+template<u32 Base, u32 Exponent>
+constexpr DigitPowers<Base> make_digit_powers()
+{
+   DigitPowers<Base> table{};
+   for(u32 d = 0; d < Base; ++d) {
+      table.values[d] = static_cast<u32>(power(d, Exponent));
+   }
+   return table;
+}
+
+struct CycleCount {
+   std::vector<u32> cycle{}; // the cycle itself, starting from its smallest number
+   u128 count{0}; // how many starting numbers end up in it
+};
+
+struct FamilyCounts {
+   u32 base{10};
+   u32 exponent{2};
+   u32 digits{DEFAULT_DIGITS};
+   std::vector<CycleCount> cycles{};
+};
+
+template<u32 Base, u32 Exponent>
+class DigitPowerFamily {
+private:
+   static_assert(Base >= 2 && Exponent >= 1, "there's no family without at least 2 digits and a power");
+   
+   // the most digits whose count still fits in a u128, for base 10 that's MAX_COUNT_DIGITS
+   static constexpr u32 find_max_digits()
+   {
+      u32 digits{0};
+      u128 limit{1};
+      while(limit <= ~u128{0} / Base) {
+	 limit *= Base;
+	 ++digits;
+      }
+      return digits;
+   }
+
+   // the fewest digits d where d * (Base - 1)^Exponent has at most d digits itself, see squigit_bound() for why the bound can't go below it
+   static constexpr u32 find_closed_digits()
+   {
+      u32 digits{1};
+      u128 limit{Base};
+      while(u128{digits} * power(Base - 1, Exponent) >= limit) {
+	 ++digits;
+	 limit *= Base;
+      }
+      return digits;
+   }
+   
+public:
+   static constexpr DigitPowers<Base> POWERS = make_digit_powers<Base, Exponent>();
+   static constexpr u32 MAX_DIGITS = find_max_digits();
+   static constexpr u32 CLOSED_DIGITS = find_closed_digits();
+   static constexpr u32 MAX_DIGIT_POWER = static_cast<u32>(power(Base - 1, Exponent)); // what one digit can add at most
+   static_assert(power(Base - 1, Exponent) * MAX_DIGITS <= 0xFFFFFFFF, "the digit power sums have to fit in a u32");
+
+   static constexpr u32 digit_power_sum(u64 val)
+   {
+      u32 ans{0};
+      while(val != 0) {
+	 ans += POWERS.values[val % Base];
+	 val /= Base;
+      }
+      return ans;
+   }
+
+   // digit_power_sum() of anything up to bound(digits) is still up to bound(digits), as long as it's at least one of the numbers below Base^digits
+   static u32 bound(u32 digits)
+   {
+      return std::max(digits, CLOSED_DIGITS) * MAX_DIGIT_POWER;
+   }
+
+   // DigitSumDPMethod for this family: how many numbers of up to digits digits have each digit power sum, then which cycle each sum goes to
+   static FamilyCounts count(u32 digits)
+   {
+      if(digits == 0 || digits > MAX_DIGITS) {
+	 throw std::out_of_range{"digit count for base " + std::to_string(Base) + " must be between 1 and " + std::to_string(MAX_DIGITS)};
+      }
+      
+      const CycleMap cycles = find_cycles(bound(digits), digit_power_sum);
+      
+      std::vector<u128> count(MAX_DIGIT_POWER * digits + 1, 0);
+      count[0] = 1;
+      for(u32 n = 1; n <= digits; ++n) {
+	 for(u32 s = MAX_DIGIT_POWER * n; s > 0; --s) {
+	    for(u32 d = 1; d < Base && POWERS.values[d] <= s; ++d) {
+	       count[s] += count[s - POWERS.values[d]];
+	    }
+	 }
+      }
+
+      std::vector<u128> per_cycle(cycles.cycles.size(), 0);
+      for(u32 s = 1; s < count.size(); ++s) {
+	 per_cycle[cycles.ids[s]] += count[s];
+      }
+      
+      FamilyCounts ans{};
+      ans.base = Base;
+      ans.exponent = Exponent;
+      ans.digits = digits;
+      for(u32 id = 0; id < cycles.cycles.size(); ++id) {
+	 if(id != cycles.ids[0]) { // 0 is a cycle all by itself, but it isn't one of our starting numbers
+	    ans.cycles.push_back(CycleCount{cycles.cycles[id], per_cycle[id]});
+	 }
+      }
+      return ans;
+   }
+};
+// in C++14 a static constexpr member still needs a definition out here as soon as anything takes its address or binds a reference to it (std::max() does), or it only links when the optimiser happens to get rid of that
+template<u32 Base, u32 Exponent>
+constexpr DigitPowers<Base> DigitPowerFamily<Base, Exponent>::POWERS;
+template<u32 Base, u32 Exponent>
+constexpr u32 DigitPowerFamily<Base, Exponent>::MAX_DIGITS;
+template<u32 Base, u32 Exponent>
+constexpr u32 DigitPowerFamily<Base, Exponent>::CLOSED_DIGITS;
+template<u32 Base, u32 Exponent>
+constexpr u32 DigitPowerFamily<Base, Exponent>::MAX_DIGIT_POWER;
+
+static_assert(DigitPowerFamily<10, 2>::digit_power_sum(89) == squigit(89), "the base 10 squares family is the squigit");
+static_assert(DigitPowerFamily<10, 2>::MAX_DIGITS == MAX_COUNT_DIGITS && DigitPowerFamily<10, 2>::CLOSED_DIGITS == 3, "and it has the same limits as the squigit");
+
+
+// every family the command line can ask for, each one is its own instantiation so the compiler gets to specialize the digit power table and the loops for it
+struct FamilyInfo {
+   u32 base;
+   u32 exponent;
+   FamilyCounts (*count)(u32 digits);
+};
+
+const FamilyInfo FAMILIES[] = {
+   {10, 2, DigitPowerFamily<10, 2>::count},
+   {10, 3, DigitPowerFamily<10, 3>::count},
+   {10, 4, DigitPowerFamily<10, 4>::count},
+   {10, 5, DigitPowerFamily<10, 5>::count},
+   {2, 2, DigitPowerFamily<2, 2>::count},
+   {3, 2, DigitPowerFamily<3, 2>::count},
+   {8, 2, DigitPowerFamily<8, 2>::count},
+   {16, 2, DigitPowerFamily<16, 2>::count},
+};
+
+FamilyCounts count_family(u32 base, u32 exponent, u32 digits);
+
+
+/*
+A fixed size buffer in front of a file descriptor, for when we write far more than fits in memory (every number below 10^10 that reaches 89 is 8.5 billion lines). Everything gets copied in and goes out in big sequential write() calls once the buffer is full, so the memory use never changes no matter how much we write, and we skip all of iostream's per-call overhead.
+ */
+class OutputBuffer {
+private:
+   static const u32 SIZE{1 << 20};
+   
+   int fd{-1};
+   bool owns_fd{false};
+   std::unique_ptr<char[]> data{new char[SIZE]};
+   u32 used{0};
+
+public:
+   // stdout
+   OutputBuffer()
+      : fd{STDOUT_FILENO}
+   {
+   }
+
+   explicit OutputBuffer(const std::string &path)
+      : fd{::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)}, owns_fd{true}
+   {
+      if(fd < 0) {
+	 throw std::runtime_error{"can't open \"" + path + "\": " + std::strerror(errno)};
+      }
+   }
+
+   OutputBuffer(const OutputBuffer &) = delete;
+   OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+   ~OutputBuffer()
+   {
+      // whoever's done with us should have called flush() to find out if it worked, this is just so nothing gets lost if they didn't
+      if(used != 0) {
+	 if(::write(fd, data.get(), used) < 0) {
+	    used = 0;
+	 }
+      }
+      if(owns_fd) {
+	 ::close(fd);
+      }
+   }
+
+   // room for at least size more bytes, which have to fit in the buffer in the first place
+   char *reserve(u32 size)
+   {
+      if(used + size > SIZE) {
+	 flush();
+      }
+      return data.get() + used;
+   }
+
+   void commit(u32 size)
+   {
+      used += size;
+   }
+
+   // for blocks of any size, the big ones skip the buffer and go straight out
+   void append(const void *block, u64 size)
+   {
+      if(size > SIZE) {
+	 flush();
+	 write_all(static_cast<const char *>(block), size, -1);
+	 return;
+      }
+      std::memcpy(reserve(static_cast<u32>(size)), block, size);
+      commit(static_cast<u32>(size));
+   }
+
+   // overwrites what's already been written at offset (like a header we only know the contents of at the end)
+   void write_at(u64 offset, const void *block, u64 size)
+   {
+      flush();
+      write_all(static_cast<const char *>(block), size, static_cast<off_t>(offset));
+   }
+
+   void flush()
+   {
+      const u32 size{used};
+      used = 0;
+      write_all(data.get(), size, -1);
+   }
+
+private:
+   // write() (or pwrite() at offset when it isn't -1) until all of it is out, they're allowed to stop short
+   void write_all(const char *block, u64 size, off_t offset)
+   {
+      u64 written{0};
+      while(written < size) {
+	 const ssize_t ans = offset < 0 ? ::write(fd, block + written, size - written) : ::pwrite(fd, block + written, size - written, offset + static_cast<off_t>(written));
+	 if(ans < 0 && errno == EINTR) {
+	    continue;
+	 }
+	 if(ans <= 0) {
+	    throw std::runtime_error{std::string{"write failed: "} + std::strerror(errno)};
+	 }
+	 written += static_cast<u64>(ans);
+      }
+   }
+};
+
+
+/*
+The file generate writes and lookup reads: a 64 byte header and then one bit for every number in [0, limit), bit n % 64 of word n / 64 being set when n reaches 89 (so 10^9 numbers is 125MB). The words are written the way this machine keeps them in memory, which is little endian on everything we run on, and since the header is 64 bytes the words stay 8 byte aligned when the file is mapped so BitsetFile can read them in place.
+The checksum is FNV-1a over the words, one word at a time instead of one byte.
+ */
+struct BitsetFileHeader {
+   char magic[8]; // "P92BITS" and a 0
+   u32 version;
+   u32 base; // what was summed, the squigit so far is the only one
+   u32 exponent;
+   u32 digits;
+   u64 limit; // 10^digits
+   u64 words;
+   u64 count_89; // how many of the bits are set, which is just the answer for the limit
+   u64 checksum;
+   u64 reserved;
+};
+static_assert(sizeof(BitsetFileHeader) == 64, "the header has to keep the words 8 byte aligned");
+
+const char BITSET_MAGIC[8] = {'P', '9', '2', 'B', 'I', 'T', 'S', '\0'};
+const u32 BITSET_VERSION{1};
+const u64 FNV_OFFSET{0xCBF29CE484222325};
+const u64 FNV_PRIME{0x100000001B3};
+
+inline u64 fnv_words(u64 hash, const u64 *words, u64 count)
+{
+   for(u64 i = 0; i < count; ++i) {
+      hash = (hash ^ words[i]) * FNV_PRIME;
+   }
+   return hash;
+}
+
+u64 generate_bitset_file(u32 digits, u32 threads, const std::string &path);
+
+
+// a generate file mapped straight into memory, so opening one only costs the header check and every lookup is one load
+class BitsetFile {
+private:
+   int fd{-1};
+   const char *mapping{nullptr};
+   u64 size{0};
+   const BitsetFileHeader *header{nullptr};
+   const u64 *words{nullptr};
+
+   void release()
+   {
+      if(mapping != nullptr) {
+	 ::munmap(const_cast<char *>(mapping), size);
+	 mapping = nullptr;
+      }
+      if(fd >= 0) {
+	 ::close(fd);
+	 fd = -1;
+      }
+   }
+
+public:
+   explicit BitsetFile(const std::string &path)
+      : fd{::open(path.c_str(), O_RDONLY)}
+   {
+      if(fd < 0) {
+	 throw std::runtime_error{"can't open \"" + path + "\": " + std::strerror(errno)};
+      }
+      struct stat info{};
+      if(::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(BitsetFileHeader))) {
+	 ::close(fd);
+	 throw std::runtime_error{"\"" + path + "\" is too small to be a bitset file"};
+      }
+      size = static_cast<u64>(info.st_size);
+      void *ans = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+      if(ans == MAP_FAILED) {
+	 ::close(fd);
+	 throw std::runtime_error{"can't map \"" + path + "\": " + std::strerror(errno)};
+      }
+      mapping = static_cast<const char *>(ans);
+      header = reinterpret_cast<const BitsetFileHeader *>(mapping);
+      words = reinterpret_cast<const u64 *>(mapping + sizeof(BitsetFileHeader));
+
+      std::string problem{};
+      if(std::memcmp(header->magic, BITSET_MAGIC, sizeof(BITSET_MAGIC)) != 0) {
+	 problem = "isn't a bitset file";
+      } else if(header->version != BITSET_VERSION) {
+	 problem = "is version " + std::to_string(header->version) + ", we only read " + std::to_string(BITSET_VERSION);
+      } else if(header->base != 10 || header->exponent != 2) {
+	 problem = "is for base " + std::to_string(header->base) + " and exponent " + std::to_string(header->exponent) + ", not the squigit";
+      } else if(header->digits == 0 || header->digits > MAX_SCAN_DIGITS || header->limit != power(10, header->digits)) {
+	 problem = "has a limit that isn't 10^1 to 10^" + std::to_string(MAX_SCAN_DIGITS) + " or doesn't match its digit count";
+      } else if(header->words != (header->limit + 63) / 64 || size != sizeof(BitsetFileHeader) + header->words * 8) { // the limit is checked first, so this can't overflow
+	 problem = "is the wrong size for its limit";
+      }
+      if(!problem.empty()) {
+	 release();
+	 throw std::runtime_error{"\"" + path + "\" " + problem};
+      }
+   }
+
+   BitsetFile(const BitsetFile &) = delete;
+   BitsetFile &operator=(const BitsetFile &) = delete;
+
+   ~BitsetFile()
+   {
+      release();
+   }
+
+   u32 digit_count() const
+   {
+      return header->digits;
+   }
+
+   u64 limit() const
+   {
+      return header->limit;
+   }
+
+   bool reaches_89(u64 n) const
+   {
+      if(n >= header->limit) {
+	 throw std::out_of_range{std::to_string(n) + " is past the end of the file, it only goes up to " + std::to_string(header->limit - 1)};
+      }
+      return (words[n / 64] >> (n % 64)) & 1;
+   }
+
+   // reads the whole file, so this is up to whoever wants to pay for it
+   bool verify() const
+   {
+      return fnv_words(FNV_OFFSET, words, header->words) == header->checksum;
+   }
+};
+
+
+// what order stream_numbers() writes the numbers in
+enum class StreamOrder {
+   ascending, // every number in order, from scanning all of them
+   grouped, // one DigitsMethod multiset after the other, each one's permutations in order
+};
+
+u128 stream_numbers(u32 digits, StreamOrder order, OutputBuffer &out);
+
+
+/*
+For DigitSumDPMethod past 10^38 (which the DP gets to easily, it's the answer that stops fitting): count_89_mod() runs the same DP with every count kept mod some modulus, and count_89_exact() runs it for enough big primes that their product is past 10^N and glues the answer back together with the Chinese remainder theorem.
+The DP only ever adds, so there are no multiplications to speed up, but every count[s] is the sum of 10 counts that each need reducing. So we let the whole sum pile up in a u64 first (that's why the modulus has to stay below 2^60) and only reduce once with Barrett's trick: with factor = 2^64 / modulus, (x * factor) >> 64 is x / modulus or one less, so a multiply and one conditional subtract replace the division.
+ */
+class BarrettReducer {
+private:
+   u64 modulus{2};
+   u64 factor{0};
+
+public:
+   explicit BarrettReducer(u64 mod)
+      : modulus{mod}, factor{static_cast<u64>((u128{1} << 64) / mod)}
+   {
+   }
+
+   u64 reduce(u64 x) const
+   {
+      const u64 quotient = static_cast<u64>((u128{x} * factor) >> 64);
+      const u64 ans = x - quotient * modulus;
+      return ans >= modulus ? ans - modulus : ans;
+   }
+};
+
+
+// just enough of a big unsigned integer for count_89_exact(): multiply by a u64 and add one, and print it out
+class BigUnsigned {
+private:
+   std::vector<u64> limbs{}; // least significant first, 64 bits each, empty is 0
+
+public:
+   void mul_add(u64 mul, u64 add)
+   {
+      u128 carry{add};
+      for(u64 &limb : limbs) {
+	 const u128 product = u128{limb} * mul + carry;
+	 limb = static_cast<u64>(product);
+	 carry = product >> 64;
+      }
+      if(carry != 0) {
+	 limbs.push_back(static_cast<u64>(carry));
+      }
+   }
+
+   std::string to_string() const
+   {
+      const u64 CHUNK{10000000000000000000u}; // 10^19, the biggest power of ten in a u64
+      std::vector<u64> rest{limbs};
+      std::vector<u64> chunks{};
+      while(!rest.empty()) {
+	 u128 remainder{0};
+	 for(u64 i = rest.size(); i-- > 0;) {
+	    const u128 current = (remainder << 64) | rest[i];
+	    rest[i] = static_cast<u64>(current / CHUNK);
+	    remainder = current % CHUNK;
+	 }
+	 chunks.push_back(static_cast<u64>(remainder));
+	 while(!rest.empty() && rest.back() == 0) {
+	    rest.pop_back();
+	 }
+      }
+      if(chunks.empty()) {
+	 return std::string{"0"};
+      }
+      
+      std::ostringstream out{};
+      out << chunks.back();
+      for(u64 i = chunks.size() - 1; i-- > 0;) {
+	 out << std::setw(19) << std::setfill('0') << chunks[i];
+      }
+      return out.str();
+   }
+};
+
+
+/*
+Arithmetic mod NTT_PRIME = 29 * 2^57 + 1 in Montgomery form, for the number theoretic transform behind count_89_ntt(). A value a is kept as a * 2^64 mod p, and then a product only needs redc(), which divides by 2^64 with a multiply and a shift instead of dividing by p. p is below 2^62 so nothing in redc() can overflow.
+p - 1 has 2^57 as a factor, so there are roots of unity for every power of two length we could ever fit in memory, and 3 generates the whole group.
+ */
+const u64 NTT_PRIME{4179340454199820289};
+const u64 NTT_GENERATOR{3};
+
+// Newton's iteration for p^-1 mod 2^64, every step doubles the number of correct bits (p * p = 1 mod 8, so p is right to 3 bits to start with)
+constexpr u64 ntt_prime_inverse()
+{
+   u64 inverse{NTT_PRIME};
+   for(u32 i = 0; i < 5; ++i) {
+      inverse *= 2 - NTT_PRIME * inverse;
+   }
+   return inverse;
+}
+
+class Montgomery {
+public:
+   static constexpr u64 NEGATIVE_INVERSE = ~ntt_prime_inverse() + 1; // -p^-1 mod 2^64
+   
+   static u64 redc(u128 t)
+   {
+      const u64 m = static_cast<u64>(t) * NEGATIVE_INVERSE;
+      const u64 ans = static_cast<u64>((t + u128{m} * NTT_PRIME) >> 64);
+      return ans >= NTT_PRIME ? ans - NTT_PRIME : ans;
+   }
+
+   static u64 mul(u64 a, u64 b)
+   {
+      return redc(u128{a} * b);
+   }
+
+   static u64 to_montgomery(u64 a)
+   {
+      // 2^128 mod p, done once
+      static const u64 r2 = [] {
+	 const u128 r = (u128{1} << 64) % NTT_PRIME;
+	 return static_cast<u64>(r * r % NTT_PRIME);
+      }();
+      return mul(a % NTT_PRIME, r2);
+   }
+
+   static u64 from_montgomery(u64 a)
+   {
+      return redc(a);
+   }
+
+   static u64 add(u64 a, u64 b)
+   {
+      const u64 ans = a + b;
+      return ans >= NTT_PRIME ? ans - NTT_PRIME : ans;
+   }
+
+   static u64 sub(u64 a, u64 b)
+   {
+      return a >= b ? a - b : a + NTT_PRIME - b;
+   }
+
+   // base and the answer in Montgomery form
+   static u64 pow(u64 base, u64 exp)
+   {
+      u64 ans = to_montgomery(1);
+      while(exp != 0) {
+	 if(exp & 1) {
+	    ans = mul(ans, base);
+	 }
+	 base = mul(base, base);
+	 exp >>= 1;
+      }
+      return ans;
+   }
+};
+constexpr u64 Montgomery::NEGATIVE_INVERSE;
+static_assert(NTT_PRIME * (~Montgomery::NEGATIVE_INVERSE + 1) == 1, "the Montgomery inverse is off");
+
+// the number theoretic transform of values in place (Montgomery form in and out), values.size() has to be a power of two, inverse = true undoes it including the 1 / size
+void ntt(std::vector<u64> &values, bool inverse);
+
+
+// what main() was asked to do on the command line, see print_usage()
+enum class OutputFormat {
+   text, // the same free-form lines print_results() and print_benchmark() print
+   json, // one JSON object per line
+   csv, // a header line and then one row per method
+};
+
+// the first argument can pick something other than running the methods, see print_usage()
+enum class Command {
+   run, // the default, run (or benchmark) the methods
+   serve, // answer queries from stdin until it runs out, see serve()
+   stream, // write every starting number that reaches 89, one per line, see stream_numbers()
+   generate, // write a BitsetFile for everything below the limit, see generate_bitset_file()
+   lookup, // look numbers up in one
+   validate, // check every method and counting engine against each other, see validate()
+   scale, // time every method across limits and thread counts as CSV, see scale()
+};
+
+struct Options {
+   Command command{Command::run};
+   std::vector<std::string> methods{}; // empty means every registered method that can handle the digit count
+   MethodConfig config{};
+   u32 warmup_runs{0};
+   u32 timed_runs{1};
+   OutputFormat format{OutputFormat::text};
+   bool help{false};
+   bool list{false};
+   bool stats{false}; // print chain_stats() instead of running the methods
+   std::vector<RangeQuery> ranges{}; // if there are any, count these instead of running the methods
+   u32 base{10};
+   u32 exponent{2};
+   bool family{false}; // --base or --exponent was given, so count the cycles of that family instead of running the methods
+   u32 preimage_target{0}; // if it isn't 0, print what goes to it instead of running the methods
+   StreamOrder order{StreamOrder::ascending}; // for the stream command
+   std::string output{}; // where the stream command writes to, empty means stdout
+   std::vector<std::string> arguments{}; // everything after the command that isn't an option
+   bool verify{false}; // for lookup, check the checksum first
+   u64 modulus{0}; // if it isn't 0, print the answer mod this instead of running the methods
+   bool exact{false}; // print the exact answer whatever the size instead of running the methods
+   bool ntt{false}; // print the answer mod NTT_PRIME from count_89_ntt() instead of running the methods
+   bool digits_given{false}; // --digits or --limit was there, so validate and scale shouldn't use their own default
+   bool threads_given{false}; // the same for --threads and scale
+};
+
+Options parse_options(int argc, char **argv);
+void print_usage(std::ostream &out);
+void print_method_list(std::ostream &out);
+void print_record(const Method &method, const BenchmarkStats &stats, OutputFormat format);
+void print_chain_stats(const ChainStats &stats, OutputFormat format);
+void print_range_counts(const std::vector<RangeQuery> &ranges, OutputFormat format);
+std::string range_count_line(const RangeCounter &counter, const RangeQuery &range, OutputFormat format);
+void serve(std::istream &in, std::ostream &out, OutputFormat format);
+std::string limit_string(u32 digits);
+void print_family_counts(const FamilyCounts &counts, OutputFormat format);
+void print_preimages(u32 digits, u32 target, OutputFormat format);
+void lookup(const std::vector<std::string> &arguments, bool verify, OutputFormat format);
+void print_big_answer(u32 digits, u64 modulus, const std::string &answer, OutputFormat format);
+
+const u32 VALIDATE_SCAN_DIGITS{8}; // by default validate runs every method at every limit from 10^1 up to this
+const u32 VALIDATE_COUNT_DIGITS{24}; // and the methods that don't scan up to this, past here DigitsMethod starts taking seconds
+const u32 VALIDATE_BIG_DIGITS[]{38, 50, 100, 1000}; // where the engines past u128 get checked against each other
+const u32 VALIDATE_RANGES{200}; // random ranges per size, small ones and ones up near 10^38
+void validate(u32 scan_digits, u32 threads);
+
+const u32 SCALE_FIRST_DIGITS{6}; // scale starts every sweep at 10^6
+const u32 SCALE_SCAN_DIGITS{8}; // and by default the scanning methods stop at 10^8, past that brute force with the reference kernel takes minutes
+const u32 SCALE_COUNT_DIGITS[]{6, 8, 10, 12, 16, 20, 24, 30, 38}; // the limits for the methods that don't scan, as far as each one goes
+const u32 SCALE_BIG_DIGITS[]{38, 100, 300, 1000}; // and for the engines past u128
+void scale(const Options &options, u32 scan_digits, u32 max_threads);
+
+
+int main(int argc, char **argv)
+{
+   try {
+      const Options options = parse_options(argc, argv);
+      if(options.help) {
+	 print_usage(std::cout);
+	 return 0;
+      }
+      if(options.list) {
+	 print_method_list(std::cout);
+	 return 0;
+      }
+      if(options.stats) {
+	 print_chain_stats(chain_stats(options.config.digits), options.format);
+	 return 0;
+      }
+      if(options.command == Command::serve) {
+	 serve(std::cin, std::cout, options.format);
+	 return 0;
+      }
+      if(options.command == Command::stream) {
+	 std::unique_ptr<OutputBuffer> out = options.output.empty() ? std::make_unique<OutputBuffer>() : std::make_unique<OutputBuffer>(options.output);
+	 stream_numbers(options.config.digits, options.order, *out);
+	 out->flush();
+	 return 0;
+      }
+      if(options.command == Command::generate) {
+	 if(options.output.empty()) {
+	    throw std::invalid_argument{"generate needs an --output file"};
+	 }
+	 const u64 count = generate_bitset_file(options.config.digits, options.config.threads, options.output);
+	 std::cout << "wrote " << options.output << ": every number below 10^" << options.config.digits << ", " << count << " of them reach 89\n";
+	 return 0;
+      }
+      if(options.command == Command::lookup) {
+	 lookup(options.arguments, options.verify, options.format);
+	 return 0;
+      }
+      if(options.command == Command::validate) {
+	 validate(options.digits_given ? options.config.digits : VALIDATE_SCAN_DIGITS, options.config.threads);
+	 return 0;
+      }
+      if(options.command == Command::scale) {
+	 scale(options, options.digits_given ? options.config.digits : SCALE_SCAN_DIGITS, options.threads_given ? options.config.threads : 0);
+	 return 0;
+      }
+      if(!options.ranges.empty()) {
+	 print_range_counts(options.ranges, options.format);
+	 return 0;
+      }
+      if(options.ntt) {
+	 print_big_answer(options.config.digits, NTT_PRIME, std::to_string(count_89_ntt(options.config.digits)), options.format);
+	 return 0;
+      }
+      if(options.exact) {
+	 print_big_answer(options.config.digits, 0, count_89_exact(options.config.digits), options.format);
+	 return 0;
+      }
+      if(options.modulus != 0) {
+	 print_big_answer(options.config.digits, options.modulus, std::to_string(count_89_mod(options.config.digits, options.modulus)), options.format);
+	 return 0;
+      }
+      if(options.preimage_target != 0) {
+	 print_preimages(options.config.digits, options.preimage_target, options.format);
+	 return 0;
+      }
+      if(options.family) {
+	 print_family_counts(count_family(options.base, options.exponent, options.config.digits), options.format);
+	 return 0;
+      }
+
+      // build them all up front so a typo in the method list fails before we spend 3 seconds on brute force
+      const MethodRegistry &registry = MethodRegistry::instance();
+      std::vector<std::unique_ptr<Method>> methods{};
+      if(options.methods.empty()) {
+	 for(const MethodInfo *info : registry.applicable(options.config.digits)) {
+	    methods.push_back(info->factory(options.config));
+	 }
+      } else {
+	 for(const std::string &name : options.methods) {
+	    methods.push_back(registry.find(name).factory(options.config));
+	 }
+      }
+
+      if(options.format == OutputFormat::text) {
+	 std::cout << "Solving Problem 92" << '\n';
+      } else if(options.format == OutputFormat::csv) {
+	 std::cout << "method,digits,limit,answer,warmup_runs,timed_runs,min_ns,median_ns,p95_ns,mean_ns,stddev_ns\n";
+      }
+
+      for(const auto &method : methods) {
+	 if(options.format == OutputFormat::text && options.warmup_runs == 0 && options.timed_runs == 1) {
+	    method->print_results();
+	 } else if(options.format == OutputFormat::text) {
+	    method->print_benchmark(options.warmup_runs, options.timed_runs);
+	 } else {
+	    print_record(*method, method->benchmark(options.warmup_runs, options.timed_runs), options.format);
+	 }
+      }
+   } catch(const std::exception &e) {
+      std::cerr << "error: " << e.what() << '\n';
+      return 1;
+   }
+
+   /*
+I used to keep rough timings of the default run here, but they were whatever my machine happened to do that day, and the fast methods finish in a few ms so a single run of them is mostly noise anyway. "./p92 scale > scale.csv" measures all of them properly now, across limits and thread counts, and is what to look at instead.
+The one thing those timings did show is that with -O2 BruteForceMethodCached and SquigitsMethod end up almost exactly as fast as each other, and the -DP92_INSTRUMENT build shows why: below ten million the cache only misses 493 times, so after the first few numbers BruteForceMethodCached is doing the same one lookup per number that SquigitsMethod does, it just fills in its table as it goes instead of up front.
+   */
+  
+   
+   /*
+THINGS I LEARNED:
+- it turns out for the cached method we only need a cache size of 567 elements because 9^2 * 7 = 567, so we don't need a massive cache size like I thought before, which would have made it way too slow.
+- under ten million, chains are at most 12 long, including the starting number.
+- trying to create an inverse (squigit) was difficult, I couldn't find a way to efficiently calculate a list of numbers that squigit to X without looping over all ten million numbers and checking, we might as well just bruteforce it if that's the case - I was going to try to make a tree with 89 or 1 at the root but that fell apart, perhaps it could be done but I don't know if it could possibly be better than the DigitsMethod.
+- combinatorics is useful for eliminating the amount of cases you have to deal with, especially for large sets of data, which is a very huge optimization in this case.
+    */
+   
+   return 0;
+}
+
+
+/*
+The biggest squigit an N digit number can have is 9^2 * N, but the cache/lookup tables also get indexed by the squigits OF squigits when we follow a chain, so the bound has to be closed under squigit. For N >= 3, 81 * N has at most N digits itself (243 < 1000) so 81 * N works, but for 1 and 2 digits a chain can climb above 81 * N (79 -> 130), so we never go below the 3 digit bound.
+ */
+u32 squigit_bound(u32 digits)
+{
+   return 81 * std::max(digits, 3u);
+}
+
+
+// std::to_string doesn't know about u128, so we build the decimal digits ourselves
+std::string u128_to_string(u128 val)
+{
+   if(val == 0) {
+      return std::string{"0"};
+   }
+
+   std::string ans{};
+   while(val != 0) {
+      ans.push_back(static_cast<char>('0' + static_cast<u32>(val % 10)));
+      val /= 10;
+   }
+   std::reverse(ans.begin(), ans.end());
+   return ans;
+}
+
+
+// squigits of every number from 0 to CHUNK_SIZE - 1, built with the reference squigit() the first time anyone asks for it
+const u16 *chunk_squigits()
+{
+#ifdef P92_PRODUCTION
+   return PRODUCTION_CHUNK_SQUIGITS.values;
+#else
+   static const std::vector<u16> chunks = [] {
+      std::vector<u16> table(CHUNK_SIZE);
+      for(u32 i = 0; i < CHUNK_SIZE; ++i) {
+	 table[i] = static_cast<u16>(squigit(i));
+      }
+      return table;
+   }();
+   return chunks.data();
+#endif
+}
+
+
+u32 squigit_chunked(u64 val)
+{
+   return squigit_chunked(val, chunk_squigits());
+}
+
+
+/*
+The squigit_batch_kernel() kernels, each one fills out[0..15] with the squigits of first, first + 1, ..., first + 15 where first is a multiple of SIMD_BATCH. Since 10000 is a multiple of 16 all 16 numbers have the same digits above the last 4, so the caller hands that part in as high_squigit (the squigit of first / 10000), and the last 4 digits (low = first % 10000 plus 0..15, always below 10000) fit in 16 bit lanes.
+We can't divide by 10 in a vector, but for anything below 65536 x / 10 is the same as (x * 0xCCCD) >> 19, and the top half of a 16 bit multiply gives us (x * 0xCCCD) >> 16 for free.
+ */
+void squigit_batch_scalar(u32 high_squigit, u32 low, u32 *out)
+{
+   for(u32 j = 0; j < SIMD_BATCH; ++j) {
+      u32 x{low + j};
+      u32 ans{high_squigit};
+      for(u32 d = 0; d < CHUNK_DIGITS; ++d) {
+	 ans += (x % 10) * (x % 10);
+	 x /= 10;
+      }
+      out[j] = ans;
+   }
+}
+
+
+#ifdef P92_X86_SIMD
+// AVX2 has 16 lanes of 16 bits, exactly one batch. AVX-512 wouldn't buy anything here because a batch of 32 would straddle 4 digit chunks (10000 isn't a multiple of 32). This leaves the 16 squigits as 2 vectors of 8 u32s
+__attribute__((target("avx2")))
+inline void squigit_lanes_avx2(u32 high_squigit, u32 low, __m256i &first_half, __m256i &second_half)
+{
+   __m256i x = _mm256_add_epi16(_mm256_set1_epi16(static_cast<short>(low)), _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+   __m256i sum = _mm256_setzero_si256();
+   const __m256i magic = _mm256_set1_epi16(static_cast<short>(0xCCCD));
+   const __m256i ten = _mm256_set1_epi16(10);
+   
+   for(u32 d = 0; d < CHUNK_DIGITS; ++d) {
+      const __m256i quotient = _mm256_srli_epi16(_mm256_mulhi_epu16(x, magic), 3);
+      const __m256i digit = _mm256_sub_epi16(x, _mm256_mullo_epi16(quotient, ten));
+      sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(digit, digit));
+      x = quotient;
+   }
+
+   const __m256i high_sum = _mm256_set1_epi32(static_cast<int>(high_squigit));
+   first_half = _mm256_add_epi32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(sum)), high_sum);
+   second_half = _mm256_add_epi32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(sum, 1)), high_sum);
+}
+
+
+__attribute__((target("avx2")))
+void squigit_batch_avx2(u32 high_squigit, u32 low, u32 *out)
+{
+   __m256i first_half{};
+   __m256i second_half{};
+   squigit_lanes_avx2(high_squigit, low, first_half, second_half);
+   _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), first_half);
+   _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + 8), second_half);
+}
+
+
+// which of 8 squigits go to 89, as 0 or 1 per lane: gather the 32 bit half of the bitset word each one lives in, shift its bit down and mask it off (x86 is little endian, so bit i of the u64 words is bit i % 32 of 32 bit word i / 32)
+__attribute__((target("avx2")))
+inline __m256i reaches_89_lanes_avx2(__m256i squigits, const int *bit_words)
+{
+   const __m256i words = _mm256_i32gather_epi32(bit_words, _mm256_srli_epi32(squigits, 5), 4);
+   const __m256i shifts = _mm256_and_si256(squigits, _mm256_set1_epi32(31));
+   return _mm256_and_si256(_mm256_srlv_epi32(words, shifts), _mm256_set1_epi32(1));
+}
+
+
+// the squigits and the lookups both stay in vectors, which beats storing the squigits and looking them up one at a time
+__attribute__((target("avx2")))
+u32 count_89_batch_avx2(u32 high_squigit, u32 low, const TerminalBitset &reaches_89)
+{
+   __m256i first_half{};
+   __m256i second_half{};
+   squigit_lanes_avx2(high_squigit, low, first_half, second_half);
+
+   const int *bit_words = reinterpret_cast<const int *>(reaches_89.data().data());
+   const __m256i hits = _mm256_add_epi32(reaches_89_lanes_avx2(first_half, bit_words), reaches_89_lanes_avx2(second_half, bit_words));
+   __m128i total = _mm_add_epi32(_mm256_castsi256_si128(hits), _mm256_extracti128_si256(hits, 1));
+   total = _mm_hadd_epi32(total, total);
+   total = _mm_hadd_epi32(total, total);
+   return static_cast<u32>(_mm_cvtsi128_si32(total));
+}
+#endif
+
+
+#ifdef P92_NEON_SIMD
+// NEON only has 8 lanes of 16 bits, so it's two passes per batch, and there's no mulhi for u16 so we widen the multiply and narrow it back
+void squigit_batch_neon(u32 high_squigit, u32 low, u32 *out)
+{
+   static const u16 offsets[SIMD_BATCH] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+   
+   for(u32 half = 0; half < 2; ++half) {
+      uint16x8_t x = vaddq_u16(vdupq_n_u16(static_cast<u16>(low)), vld1q_u16(offsets + 8 * half));
+      uint16x8_t sum = vdupq_n_u16(0);
+      
+      for(u32 d = 0; d < CHUNK_DIGITS; ++d) {
+	 const uint32x4_t product_low = vmull_u16(vget_low_u16(x), vdup_n_u16(0xCCCD));
+	 const uint32x4_t product_high = vmull_u16(vget_high_u16(x), vdup_n_u16(0xCCCD));
+	 const uint16x8_t quotient = vshrq_n_u16(vcombine_u16(vshrn_n_u32(product_low, 16), vshrn_n_u32(product_high, 16)), 3);
+	 const uint16x8_t digit = vmlsq_u16(x, quotient, vdupq_n_u16(10));
+	 sum = vmlaq_u16(sum, digit, digit);
+	 x = quotient;
+      }
+
+      vst1q_u32(out + 8 * half, vaddq_u32(vmovl_u16(vget_low_u16(sum)), vdupq_n_u32(high_squigit)));
+      vst1q_u32(out + 8 * half + 4, vaddq_u32(vmovl_u16(vget_high_u16(sum)), vdupq_n_u32(high_squigit)));
+   }
+}
+#endif
+
+
+// the scalar and NEON versions of count_89_batch(), with no gather to speak of we just check the bits one squigit at a time
+u32 count_89_batch_scalar(u32 high_squigit, u32 low, const TerminalBitset &reaches_89)
+{
+   u32 squigits[SIMD_BATCH];
+   squigit_batch_scalar(high_squigit, low, squigits);
+   u32 ans{0};
+   for(u32 j = 0; j < SIMD_BATCH; ++j) {
+      ans += static_cast<u32>(reaches_89.reaches_89(squigits[j]));
+   }
+   return ans;
+}
+
+
+#ifdef P92_NEON_SIMD
+u32 count_89_batch_neon(u32 high_squigit, u32 low, const TerminalBitset &reaches_89)
+{
+   u32 squigits[SIMD_BATCH];
+   squigit_batch_neon(high_squigit, low, squigits);
+   u32 ans{0};
+   for(u32 j = 0; j < SIMD_BATCH; ++j) {
+      ans += static_cast<u32>(reaches_89.reaches_89(squigits[j]));
+   }
+   return ans;
+}
+#endif
+
+
+// the best squigit batch kernel this CPU can run, NEON is always there on ARM so that one is decided at compile time
+SquigitBatchFn squigit_batch_kernel()
+{
+#if defined(P92_X86_SIMD)
+   if(__builtin_cpu_supports("avx2")) {
+      return squigit_batch_avx2;
+   }
+#elif defined(P92_NEON_SIMD)
+   return squigit_batch_neon;
+#endif
+   return squigit_batch_scalar;
+}
+
+
+// and the same for count_89_batch(), how many of the 16 numbers in a batch go to 89
+Count89BatchFn count_89_batch_kernel()
+{
+#if defined(P92_X86_SIMD)
+   if(__builtin_cpu_supports("avx2")) {
+      return count_89_batch_avx2;
+   }
+#elif defined(P92_NEON_SIMD)
+   return count_89_batch_neon;
+#endif
+   return count_89_batch_scalar;
+}
+
+
+const char *squigit_batch_isa()
+{
+   const SquigitBatchFn kernel = squigit_batch_kernel();
+#if defined(P92_X86_SIMD)
+   if(kernel == squigit_batch_avx2) {
+      return "avx2";
+   }
+#elif defined(P92_NEON_SIMD)
+   if(kernel == squigit_batch_neon) {
+      return "neon";
+   }
+#endif
+   return kernel == squigit_batch_scalar ? "scalar" : "unknown";
+}
+
+
+void print_usage(std::ostream &out)
+{
+   out << "usage: p92 [options]\n"
+       << "       p92 serve [--format F]\n"
+       << "  serve reads one query per line from stdin and answers each with one line, the tables only get built once:\n"
+       << "    limit L            how many numbers in [1, L) reach 89\n"
+       << "    range A B          how many numbers in [A, B) reach 89\n"
+       << "    quit               stop, the same as the end of the input\n"
+       << "       p92 stream [--digits N] [--order ascending|grouped] [--output FILE]\n"
+       << "  stream writes every starting number below the limit that reaches 89, one per line, in order or grouped by their digits\n"
+       << "       p92 generate --digits N --output FILE [--threads T]\n"
+       << "  generate writes one bit for every number below the limit, set when it reaches 89, to a file lookup can map\n"
+       << "       p92 lookup FILE [--verify] [N ...]\n"
+       << "  lookup says whether each N (or each line of stdin if there aren't any) reaches 89, --verify checks the checksum first\n"
+       << "       p92 validate [--digits N] [--threads T]\n"
+       << "  validate checks every method at every limit up to 10^N (default: " << VALIDATE_SCAN_DIGITS << ") against brute force, the fast ones up to 10^" << VALIDATE_COUNT_DIGITS << ",\n"
+       << "  random ranges against counting them one by one, and the engines past 10^38 against each other, it fails if anything disagrees\n"
+       << "       p92 scale [--digits N] [--threads T] [--kernel K] [--runs R] [--warmup W] [--methods a,b,...]\n"
+       << "  scale times every method from 10^" << SCALE_FIRST_DIGITS << " up (the scanning ones to 10^N, default " << SCALE_SCAN_DIGITS << ", the rest to 10^1000) on 1 up to T threads\n"
+       << "  (default: one per core) and prints the median time, numbers per second and parallel efficiency of each as CSV\n"
+       << "options:\n"
+       << "  --methods a,b,...  which methods to run, see --list (default: every method that can handle the digit count)\n"
+       << "  --digits N         count the starting numbers below 10^N (default: " << DEFAULT_DIGITS << ")\n"
+       << "  --limit L          the same thing given as the limit itself, it has to be a power of ten (10000000, 1e7 or 10^7)\n"
+       << "  --kernel K         squigit kernel for the scanning methods: reference (default), chunked, incremental or blocked\n"
+       << "  --threads T        worker threads for the methods that support them, 0 means one per core (default: 1)\n"
+       << "  --runs R           timed runs per method (default: 1)\n"
+       << "  --warmup W         untimed runs before the timed ones (default: 0)\n"
+       << "  --format F         text (default), json (one object per line) or csv\n"
+       << "  --range A B        count the numbers from A up to (but not including) B that reach 89 instead of running the methods,\n"
+       << "                     A and B go up to 10^38 and --range can be given as many times as you like\n"
+       << "  --preimages X      which numbers below the limit have X as their squigit, and how many go through X at some point\n"
+       << "  --base B           count how many numbers below B^N end up in each cycle of the sums of the digit powers in base B\n"
+       << "  --exponent E       ... of the E-th powers of the digits (default 10 and 2, see --list for the ones that are built in)\n"
+       << "  --mod P            print the answer mod P (below 2^60) for limits up to 10^" << MAX_MODULAR_DIGITS << " (O(N^2), about a minute at the top) instead of running the methods\n"
+       << "  --exact            print the exact answer for limits up to 10^" << MAX_EXACT_DIGITS << " (O(N^3), about 20 seconds at the top), however many digits it has\n"
+       << "  --ntt              print the answer mod " << NTT_PRIME << " for limits up to 10^" << MAX_NTT_DIGITS << ", with polynomial powers instead of the DP\n"
+       << "  --stats            print the chain length histogram and the longest chain below the limit instead of running the methods\n"
+       << "  --list             list every registered method and what it can do, then exit\n"
+       << "  --help             print this and exit\n";
+}
+
+
+void print_method_list(std::ostream &out)
+{
+   for(const MethodInfo &info : MethodRegistry::instance().methods()) {
+      const MethodCapabilities &caps = info.capabilities;
+      out << info.name << ": up to 10^" << caps.max_digits
+	  << (caps.multithreaded ? ", multithreaded" : "")
+	  << (caps.scans_numbers ? ", scans every number" : "")
+	  << (caps.needs_precomputation ? ", needs precomputed tables" : "") << '\n';
+   }
+   out << "digit power families for --base and --exponent:";
+   for(const FamilyInfo &family : FAMILIES) {
+      out << " base " << family.base << " exponent " << family.exponent << (&family + 1 == std::end(FAMILIES) ? "" : ",");
+   }
+   out << '\n';
+}
+
+
+u32 parse_u32(const std::string &text, const std::string &flag)
+{
+   // std::stoul would happily take "-1" or "12abc", we want the whole thing to be a plain number
+   if(text.empty() || text.size() > 9 || !std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+      throw std::invalid_argument{flag + " expects a number, got \"" + text + "\""};
+   }
+   return static_cast<u32>(std::stoul(text));
+}
+
+
+// a limit is only any use to us when it's a power of ten, so we turn it straight into a digit count
+u32 parse_limit(const std::string &text)
+{
+   std::string exponent{};
+   if(text.compare(0, 3, "10^") == 0) {
+      exponent = text.substr(3);
+   } else if(text.compare(0, 2, "1e") == 0) {
+      exponent = text.substr(2);
+   } else if(text.size() > 1 && text[0] == '1' && text.find_first_not_of('0', 1) == std::string::npos) {
+      return static_cast<u32>(text.size() - 1);
+   } else {
+      throw std::invalid_argument{"--limit has to be a power of ten like 10000000, 1e7 or 10^7, got \"" + text + "\""};
+   }
+   return parse_u32(exponent, "--limit");
+}
+
+
+// a plain decimal number or a power of ten written like parse_limit() takes it, anything from 0 up to 10^38
+u128 parse_u128(const std::string &text, const std::string &flag)
+{
+   if(text.compare(0, 3, "10^") == 0 || text.compare(0, 2, "1e") == 0) {
+      const u32 exponent = parse_u32(text.substr(text[1] == 'e' ? 2 : 3), flag);
+      if(exponent > MAX_COUNT_DIGITS) {
+	 throw std::out_of_range{flag + " only goes up to 10^" + std::to_string(MAX_COUNT_DIGITS)};
+      }
+      u128 ans{1};
+      for(u32 i = 0; i < exponent; ++i) {
+	 ans *= 10;
+      }
+      return ans;
+   }
+   
+   if(text.empty() || !std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+      throw std::invalid_argument{flag + " expects a number, got \"" + text + "\""};
+   }
+   const std::string digits = text.substr(std::min(text.find_first_not_of('0'), text.size()));
+   if(digits.size() > MAX_COUNT_DIGITS && digits != limit_string(MAX_COUNT_DIGITS)) {
+      throw std::out_of_range{flag + " only goes up to 10^" + std::to_string(MAX_COUNT_DIGITS)};
+   }
+   u128 ans{0};
+   for(char c : digits) {
+      ans = ans * 10 + static_cast<u32>(c - '0');
+   }
+   return ans;
+}
+
+
+std::vector<std::string> split_list(const std::string &text)
+{
+   std::vector<std::string> ans{};
+   std::stringstream stream{text};
+   std::string item{};
+   while(std::getline(stream, item, ',')) {
+      if(!item.empty()) {
+	 ans.push_back(item);
+      }
+   }
+   return ans;
+}
+
+
+Options parse_options(int argc, char **argv)
+{
+   Options options{};
+   int first{1};
+   if(argc > 1 && argv[1][0] != '-') {
+      const std::string command{argv[1]};
+      if(command == "serve") {
+	 options.command = Command::serve;
+      } else if(command == "stream") {
+	 options.command = Command::stream;
+      } else if(command == "generate") {
+	 options.command = Command::generate;
+      } else if(command == "lookup") {
+	 options.command = Command::lookup;
+      } else if(command == "validate") {
+	 options.command = Command::validate;
+      } else if(command == "scale") {
+	 options.command = Command::scale;
+      } else {
+	 throw std::invalid_argument{"unknown command \"" + command + "\", see --help"};
+      }
+      first = 2;
+   }
+   
+   for(int i = first; i < argc; ++i) {
+      const std::string arg{argv[i]};
+      if(arg == "--help" || arg == "-h") {
+	 options.help = true;
+	 continue;
+      }
+      if(arg == "--list") {
+	 options.list = true;
+	 continue;
+      }
+      if(arg == "--stats") {
+	 options.stats = true;
+	 continue;
+      }
+      if(arg == "--verify") {
+	 options.verify = true;
+	 continue;
+      }
+      if(arg == "--exact") {
+	 options.exact = true;
+	 continue;
+      }
+      if(arg == "--ntt") {
+	 options.ntt = true;
+	 continue;
+      }
+      if(options.command != Command::run && arg[0] != '-') {
+	 options.arguments.push_back(arg);
+	 continue;
+      }
+      if(i + 1 >= argc) {
+	 throw std::invalid_argument{"unknown option or missing value for \"" + arg + "\", see --help"};
+      }
+      if(arg == "--range") {
+	 if(i + 2 >= argc) {
+	    throw std::invalid_argument{"--range expects two numbers, see --help"};
+	 }
+	 RangeQuery range{};
+	 range.from = parse_u128(argv[i + 1], arg);
+	 range.to = parse_u128(argv[i + 2], arg);
+	 if(range.from > range.to) {
+	    throw std::invalid_argument{"--range expects the smaller number first"};
+	 }
+	 options.ranges.push_back(range);
+	 i += 2;
+	 continue;
+      }
+      const std::string value{argv[++i]};
+      
+      if(arg == "--methods") {
+	 options.methods = value == "all" ? std::vector<std::string>{} : split_list(value);
+      } else if(arg == "--digits") {
+	 options.config.digits = parse_u32(value, arg);
+	 options.digits_given = true;
+      } else if(arg == "--limit") {
+	 options.config.digits = parse_limit(value);
+	 options.digits_given = true;
+      } else if(arg == "--kernel") {
+	 if(value == "reference") {
+	    options.config.kernel = SquigitKernel::reference;
+	 } else if(value == "chunked") {
+	    options.config.kernel = SquigitKernel::chunked;
+	 } else if(value == "incremental") {
+	    options.config.kernel = SquigitKernel::incremental;
+	 } else if(value == "blocked") {
+	    options.config.kernel = SquigitKernel::blocked;
+	 } else {
+	    throw std::invalid_argument{"unknown kernel \"" + value + "\""};
+	 }
+      } else if(arg == "--mod") {
+	 const u128 modulus = parse_u128(value, arg);
+	 if(modulus < 2 || modulus >= (u128{1} << 60)) {
+	    throw std::out_of_range{"--mod has to be between 2 and 2^60"};
+	 }
+	 options.modulus = static_cast<u64>(modulus);
+      } else if(arg == "--order") {
+	 if(value == "ascending") {
+	    options.order = StreamOrder::ascending;
+	 } else if(value == "grouped") {
+	    options.order = StreamOrder::grouped;
+	 } else {
+	    throw std::invalid_argument{"unknown order \"" + value + "\""};
+	 }
+      } else if(arg == "--output") {
+	 options.output = value;
+      } else if(arg == "--preimages") {
+	 options.preimage_target = parse_u32(value, arg);
+	 if(options.preimage_target == 0) {
+	    throw std::invalid_argument{"--preimages expects a target of at least 1"};
+	 }
+      } else if(arg == "--base") {
+	 options.base = parse_u32(value, arg);
+	 options.family = true;
+      } else if(arg == "--exponent") {
+	 options.exponent = parse_u32(value, arg);
+	 options.family = true;
+      } else if(arg == "--threads") {
+	 options.config.threads = parse_u32(value, arg);
+	 options.threads_given = true;
+      } else if(arg == "--runs") {
+	 options.timed_runs = parse_u32(value, arg);
+      } else if(arg == "--warmup") {
+	 options.warmup_runs = parse_u32(value, arg);
+      } else if(arg == "--format") {
+	 if(value == "text") {
+	    options.format = OutputFormat::text;
+	 } else if(value == "json") {
+	    options.format = OutputFormat::json;
+	 } else if(value == "csv") {
+	    options.format = OutputFormat::csv;
+	 } else {
+	    throw std::invalid_argument{"unknown format \"" + value + "\""};
+	 }
+      } else {
+	 throw std::invalid_argument{"unknown option \"" + arg + "\", see --help"};
+      }
+   }
+
+   return options;
+}
+
+
+// 10^digits written out, this works past u64 since it's just a 1 and some zeros
+std::string limit_string(u32 digits)
+{
+   return "1" + std::string(digits, '0');
+}
+
+
+// one machine readable record per method, the answer is written as a string in the JSON since it can be way past what a double holds exactly
+void print_record(const Method &method, const BenchmarkStats &stats, OutputFormat format)
+{
+   std::ostringstream line{};
+   line << std::fixed << std::setprecision(0);
+   
+   if(format == OutputFormat::json) {
+      line << "{\"method\":\"" << method.class_type << "\""
+	   << ",\"digits\":" << method.digit_count()
+	   << ",\"limit\":\"" << limit_string(method.digit_count()) << "\""
+	   << ",\"answer\":\"" << u128_to_string(stats.answer) << "\""
+	   << ",\"warmup_runs\":" << stats.warmup_runs
+	   << ",\"timed_runs\":" << stats.timed_runs
+	   << ",\"min_ns\":" << stats.min_ns
+	   << ",\"median_ns\":" << stats.median_ns
+	   << ",\"p95_ns\":" << stats.p95_ns
+	   << ",\"mean_ns\":" << stats.mean_ns
+	   << ",\"stddev_ns\":" << stats.stddev_ns << "}";
+   } else {
+      line << method.class_type << ',' << method.digit_count() << ',' << limit_string(method.digit_count()) << ',' << u128_to_string(stats.answer)
+	   << ',' << stats.warmup_runs << ',' << stats.timed_runs
+	   << ',' << stats.min_ns << ',' << stats.median_ns << ',' << stats.p95_ns << ',' << stats.mean_ns << ',' << stats.stddev_ns;
+   }
+   
+   std::cout << line.str() << '\n';
+}
+
+
+// a * b, but throws instead of silently wrapping around when the answer doesn't fit in a u128
+u128 checked_mul(u128 a, u128 b)
+{
+   u128 ans{0};
+   if(__builtin_mul_overflow(a, b, &ans)) {
+      throw std::overflow_error{"count doesn't fit in 128 bits"};
+   }
+   return ans;
+}
+
+
+/*
+val * mul / div for when we know the division comes out exact (like going from (r choose c - 1) to (r choose c)), without val * mul ever overflowing when the answer itself fits.
+With g = gcd(mul, div), val * (mul / g) is a multiple of div / g, and since mul / g and div / g share no factors, val itself has to be a multiple of div / g. So we can divide first and only multiply afterwards, and that multiply is the final answer so checked_mul() catches it if it really doesn't fit.
+ */
+u128 mul_div_exact(u128 val, u32 mul, u32 div)
+{
+   u128 product{0};
+   if(!__builtin_mul_overflow(val, u128{mul}, &product)) {
+      return product / div; // the easy case, which is nearly all of them
+   }
+   
+   u32 a{mul};
+   u32 b{div};
+   while(b != 0) {
+      const u32 t = a % b;
+      a = b;
+      b = t;
+   }
+   return checked_mul(val / (div / a), mul / a);
+}
+
+
+// the exact number of distinct orderings of counts[0] + ... + counts[parts - 1] things where the ones in each group look the same, built up one (n choose k) at a time so it never needs a factorial bigger than the answer (the old fact() overflowed u32 at 13!)
+u128 multinomial(const u32 *counts, u32 parts)
+{
+   u128 ans{1};
+   u32 total{0};
+   for(u32 i = 0; i < parts; ++i) {
+      for(u32 k = 1; k <= counts[i]; ++k) {
+	 ++total;
+	 ans = mul_div_exact(ans, total, k);
+      }
+   }
+   return ans;
+}
+
+
+/*
+ans[n][s] = how many strings of n digits (leading zeros allowed, so the numbers from 0 to 10^n - 1) have a squigit of s, for every n up to digits. Every row is 81 * digits + 1 long so they all line up.
+ */
+std::vector<std::vector<u128>> squigit_distributions(u32 digits)
+{
+   std::vector<std::vector<u128>> ans(digits + 1, std::vector<u128>(81 * digits + 1, 0));
+   ans[0][0] = 1;
+   for(u32 n = 1; n <= digits; ++n) {
+      for(u32 s = 0; s <= 81 * n; ++s) {
+	 for(u32 d = 0; d <= 9 && d * d <= s; ++d) {
+	    ans[n][s] += ans[n - 1][s - d * d];
+	 }
+      }
+   }
+   return ans;
+}
+
+
+/*
+Finds the smallest number of exactly length digits with a squigit of target that isn't 1 or 89 (those two have chains of 1 no matter what their squigit says). min_digits[t] is the fewest digits with a squigit of t, so a prefix can always be finished off with remaining digits as long as min_digits[what's left] <= remaining, which means trying the digits smallest first hits the answer almost straight away.
+ */
+bool smallest_with_squigit(u32 target, u32 remaining, bool leading, u128 prefix, const std::vector<u32> &min_digits, u128 &ans)
+{
+   if(remaining == 0) {
+      if(target != 0 || prefix == 1 || prefix == 89) {
+	 return false;
+      }
+      ans = prefix;
+      return true;
+   }
+   for(u32 d = leading ? 1 : 0; d <= 9 && d * d <= target; ++d) {
+      if(min_digits[target - d * d] <= remaining - 1 && smallest_with_squigit(target - d * d, remaining - 1, false, prefix * 10 + d, min_digits, ans)) {
+	 return true;
+      }
+   }
+   return false;
+}
+
+
+ChainStats chain_stats(u32 digits)
+{
+   if(digits == 0 || digits > MAX_COUNT_DIGITS) {
+      throw std::out_of_range{"digit count must be between 1 and " + std::to_string(MAX_COUNT_DIGITS)};
+   }
+   
+   const std::vector<u128> count = squigit_distributions(digits)[digits];
+   const u32 max_squigit{81 * digits};
+   const u32 bound{squigit_bound(digits)};
+
+   // how long the chain of every squigit is and where it ends, none of these are ever longer than about 10
+   std::vector<u32> chain_length(bound + 1, 0);
+   std::vector<u32> terminal(bound + 1, 0);
+   for(u32 s = 1; s <= bound; ++s) {
+      u32 val{s};
+      u32 length{1};
+      while(val != 1 && val != 89) {
+	 val = squigit(val);
+	 ++length;
+      }
+      chain_length[s] = length;
+      terminal[s] = val;
+   }
+
+   ChainStats stats{};
+   stats.digits = digits;
+   u32 longest_possible{0};
+   for(u32 s = 1; s <= max_squigit; ++s) {
+      longest_possible = std::max(longest_possible, chain_length[s] + 1);
+   }
+   stats.lengths_to_1.assign(longest_possible + 1, 0);
+   stats.lengths_to_89.assign(longest_possible + 1, 0);
+
+   for(u32 s = 1; s <= max_squigit; ++s) {
+      if(count[s] != 0) {
+	 (terminal[s] == 89 ? stats.lengths_to_89 : stats.lengths_to_1)[chain_length[s] + 1] += count[s];
+      }
+   }
+   // 1 and 89 got counted as 1 longer than their squigits' chains, but they're already where they're going
+   --stats.lengths_to_1[chain_length[1] + 1];
+   ++stats.lengths_to_1[1];
+   if(digits >= 2) {
+      --stats.lengths_to_89[chain_length[145] + 1];
+      ++stats.lengths_to_89[1];
+   }
+
+   for(u32 length = 1; length <= longest_possible; ++length) {
+      stats.reaching_1 += stats.lengths_to_1[length];
+      stats.reaching_89 += stats.lengths_to_89[length];
+      if(stats.lengths_to_1[length] + stats.lengths_to_89[length] != 0) {
+	 stats.longest_chain = length;
+	 stats.longest_chain_count = stats.lengths_to_1[length] + stats.lengths_to_89[length];
+      }
+   }
+
+   std::vector<u32> min_digits(max_squigit + 1, digits + 1);
+   min_digits[0] = 0;
+   for(u32 t = 1; t <= max_squigit; ++t) {
+      for(u32 d = 1; d <= 9 && d * d <= t; ++d) {
+	 min_digits[t] = std::min(min_digits[t], min_digits[t - d * d] + 1);
+      }
+   }
+   
+   // fewer digits always means a smaller number, so the first length that has one has the smallest
+   u128 example{0};
+   for(u32 length = 1; length <= digits && example == 0; ++length) {
+      for(u32 s = 1; s <= max_squigit; ++s) {
+	 u128 candidate{0};
+	 if(chain_length[s] + 1 == stats.longest_chain && smallest_with_squigit(s, length, true, 0, min_digits, candidate) && (example == 0 || candidate < example)) {
+	    example = candidate;
+	 }
+      }
+   }
+   
+   stats.longest_chain_example.push_back(example);
+   u128 val{example};
+   while(val != 1 && val != 89) {
+      u32 next{0};
+      for(u128 rest = val; rest != 0; rest /= 10) {
+	 next += static_cast<u32>((rest % 10) * (rest % 10));
+      }
+      val = next;
+      stats.longest_chain_example.push_back(val);
+   }
+   
+   return stats;
+}
+
+
+void print_chain_stats(const ChainStats &stats, OutputFormat format)
+{
+   const u32 longest{stats.longest_chain};
+   std::ostringstream out{};
+   
+   if(format == OutputFormat::json) {
+      out << "{\"digits\":" << stats.digits
+	  << ",\"limit\":\"" << limit_string(stats.digits) << "\""
+	  << ",\"reaching_1\":\"" << u128_to_string(stats.reaching_1) << "\""
+	  << ",\"reaching_89\":\"" << u128_to_string(stats.reaching_89) << "\"";
+      const char *names[2] = {"lengths_to_1", "lengths_to_89"};
+      const std::vector<u128> *histograms[2] = {&stats.lengths_to_1, &stats.lengths_to_89};
+      for(u32 h = 0; h < 2; ++h) {
+	 out << ",\"" << names[h] << "\":{";
+	 for(u32 length = 1; length <= longest; ++length) {
+	    out << (length > 1 ? "," : "") << '"' << length << "\":\"" << u128_to_string((*histograms[h])[length]) << '"';
+	 }
+	 out << '}';
+      }
+      out << ",\"longest_chain\":" << stats.longest_chain
+	  << ",\"longest_chain_count\":\"" << u128_to_string(stats.longest_chain_count) << "\""
+	  << ",\"longest_chain_example\":[";
+      for(u32 i = 0; i < stats.longest_chain_example.size(); ++i) {
+	 out << (i > 0 ? "," : "") << '"' << u128_to_string(stats.longest_chain_example[i]) << '"';
+      }
+      out << "]}\n";
+   } else if(format == OutputFormat::csv) {
+      out << "digits,limit,terminal,chain_length,count\n";
+      for(u32 length = 1; length <= longest; ++length) {
+	 out << stats.digits << ',' << limit_string(stats.digits) << ",1," << length << ',' << u128_to_string(stats.lengths_to_1[length]) << '\n'
+	     << stats.digits << ',' << limit_string(stats.digits) << ",89," << length << ',' << u128_to_string(stats.lengths_to_89[length]) << '\n';
+      }
+   } else {
+      out << "Chains of the starting numbers below 10^" << stats.digits << '\n'
+	  << "reaching 1: " << u128_to_string(stats.reaching_1) << '\n'
+	  << "reaching 89: " << u128_to_string(stats.reaching_89) << '\n';
+      for(u32 length = 1; length <= longest; ++length) {
+	 out << "chain length " << length << ": " << u128_to_string(stats.lengths_to_1[length]) << " reach 1, " << u128_to_string(stats.lengths_to_89[length]) << " reach 89\n";
+      }
+      out << "longest chain: " << stats.longest_chain << " long, " << u128_to_string(stats.longest_chain_count) << " starting numbers, the smallest one goes";
+      for(u32 i = 0; i < stats.longest_chain_example.size(); ++i) {
+	 out << (i > 0 ? " -> " : " ") << u128_to_string(stats.longest_chain_example[i]);
+      }
+      out << '\n';
+   }
+   
+   std::cout << out.str();
+}
+
+
+void print_range_counts(const std::vector<RangeQuery> &ranges, OutputFormat format)
+{
+   const RangeCounter counter{};
+   std::ostringstream out{};
+   if(format == OutputFormat::csv) {
+      out << "from,to,answer\n";
+   }
+   
+   for(const RangeQuery &range : ranges) {
+      out << range_count_line(counter, range, format) << '\n';
+   }
+   
+   std::cout << out.str();
+}
+
+
+std::string range_count_line(const RangeCounter &counter, const RangeQuery &range, OutputFormat format)
+{
+   const std::string from = u128_to_string(range.from);
+   const std::string to = u128_to_string(range.to);
+   const std::string answer = u128_to_string(counter.count(range.from, range.to));
+   if(format == OutputFormat::json) {
+      return "{\"from\":\"" + from + "\",\"to\":\"" + to + "\",\"answer\":\"" + answer + "\"}";
+   } else if(format == OutputFormat::csv) {
+      return from + ',' + to + ',' + answer;
+   }
+   return "numbers in [" + from + ", " + to + ") that reach 89: " + answer;
+}
+
+
+/*
+The long running version of --range, for when something asks us for a lot of counts one after the other and starting the process and building the tables every time would take way longer than the counting. The RangeCounter gets built once up front, and then every line of input is one query and gets exactly one line back, even when it's broken ("error: ..." instead of the answer, and we keep going).
+Whatever's calling us probably sends queries in bursts, so instead of flushing after every answer we only flush once all the input we've already got is answered, that way a burst of queries goes back as one write.
+ */
+void serve(std::istream &in, std::ostream &out, OutputFormat format)
+{
+   std::ios::sync_with_stdio(false); // otherwise std::cin doesn't buffer anything and in_avail() is always 0
+   const RangeCounter counter{};
+   if(format == OutputFormat::csv) {
+      out << "from,to,answer\n" << std::flush;
+   }
+   
+   std::string line{};
+   while(std::getline(in, line)) {
+      std::stringstream words{line};
+      std::string query{};
+      if(!(words >> query)) {
+	 continue;
+      }
+      if(query == "quit") {
+	 break;
+      }
+
+      try {
+	 std::vector<std::string> args{};
+	 std::string arg{};
+	 while(words >> arg) {
+	    args.push_back(arg);
+	 }
+	 
+	 RangeQuery range{};
+	 if(query == "limit" && args.size() == 1) {
+	    range.from = 1;
+	    range.to = parse_u128(args[0], query);
+	 } else if(query == "range" && args.size() == 2) {
+	    range.from = parse_u128(args[0], query);
+	    range.to = parse_u128(args[1], query);
+	 } else {
+	    throw std::invalid_argument{"expected \"limit L\" or \"range A B\", got \"" + line + "\""};
+	 }
+	 out << range_count_line(counter, range, format) << '\n';
+      } catch(const std::exception &e) {
+	 out << "error: " << e.what() << '\n';
+      }
+
+      if(in.rdbuf()->in_avail() <= 0) {
+	 out << std::flush;
+      }
+   }
+   out << std::flush;
+}
+
+
+FamilyCounts count_family(u32 base, u32 exponent, u32 digits)
+{
+   for(const FamilyInfo &family : FAMILIES) {
+      if(family.base == base && family.exponent == exponent) {
+	 return family.count(digits);
+      }
+   }
+   throw std::invalid_argument{"there's no digit power family for base " + std::to_string(base) + " and exponent " + std::to_string(exponent) + ", see --list"};
+}
+
+
+void print_family_counts(const FamilyCounts &counts, OutputFormat format)
+{
+   std::ostringstream out{};
+   if(format == OutputFormat::json) {
+      out << "{\"base\":" << counts.base << ",\"exponent\":" << counts.exponent << ",\"digits\":" << counts.digits << ",\"cycles\":[";
+      for(u32 i = 0; i < counts.cycles.size(); ++i) {
+	 out << (i > 0 ? "," : "") << "{\"cycle\":[";
+	 for(u32 j = 0; j < counts.cycles[i].cycle.size(); ++j) {
+	    out << (j > 0 ? "," : "") << counts.cycles[i].cycle[j];
+	 }
+	 out << "],\"count\":\"" << u128_to_string(counts.cycles[i].count) << "\"}";
+      }
+      out << "]}\n";
+   } else if(format == OutputFormat::csv) {
+      out << "base,exponent,digits,cycle,count\n";
+      for(const CycleCount &cycle : counts.cycles) {
+	 out << counts.base << ',' << counts.exponent << ',' << counts.digits << ',';
+	 for(u32 j = 0; j < cycle.cycle.size(); ++j) {
+	    out << (j > 0 ? " " : "") << cycle.cycle[j];
+	 }
+	 out << ',' << u128_to_string(cycle.count) << '\n';
+      }
+   } else {
+      out << "Sums of the base " << counts.base << " digits to the power of " << counts.exponent << ", starting numbers below " << counts.base << '^' << counts.digits << '\n';
+      for(const CycleCount &cycle : counts.cycles) {
+	 out << "cycle";
+	 for(u32 x : cycle.cycle) {
+	    out << ' ' << x << " ->";
+	 }
+	 out << ' ' << cycle.cycle[0] << ": " << u128_to_string(cycle.count) << '\n';
+      }
+   }
+   std::cout << out.str();
+}
+
+
+void print_preimages(u32 digits, u32 target, OutputFormat format)
+{
+   if(digits == 0 || digits > MAX_SCAN_DIGITS) {
+      throw std::out_of_range{"digit count must be between 1 and " + std::to_string(MAX_SCAN_DIGITS)};
+   }
+   const ReverseTree tree{digits};
+   const std::vector<std::vector<u32>> levels = tree.levels(target);
    
-   u32 i = 1;
-   while(val != 0) {
-      u32 mod_val = val % power(10, i);
-      val -= mod_val;
-      ans += (mod_val / power(10, i - 1)) * (mod_val / power(10, i - 1));
-      ++i;
-      // std::cout << "val: " << val << ", ans: " << ans << ", mod val:" << mod_val << "\n";
+   // each multiset as its smallest number, which is just its digits in order with the zeroes at the front dropped
+   std::vector<std::pair<std::string, u128>> groups{};
+   tree.multisets().for_each(target, [&groups](const u32 *digit_counts, u128 permutations) {
+      std::string smallest{};
+      for(u32 d = 1; d < 10; ++d) {
+	 smallest.append(digit_counts[d], static_cast<char>('0' + d));
+      }
+      groups.emplace_back(smallest, permutations);
+   });
+   std::sort(groups.begin(), groups.end(), [](const std::pair<std::string, u128> &a, const std::pair<std::string, u128> &b) {
+      return a.first.size() != b.first.size() ? a.first.size() < b.first.size() : a.first < b.first;
+   });
+
+   std::ostringstream out{};
+   if(format == OutputFormat::json) {
+      out << "{\"digits\":" << digits << ",\"target\":" << target
+	  << ",\"landing_on\":\"" << u128_to_string(tree.count_landing_on(target)) << "\""
+	  << ",\"reaching\":\"" << u128_to_string(tree.count_reaching(target)) << "\",\"levels\":[";
+      for(u32 k = 0; k < levels.size(); ++k) {
+	 out << (k > 0 ? "," : "") << '[';
+	 for(u32 i = 0; i < levels[k].size(); ++i) {
+	    out << (i > 0 ? "," : "") << levels[k][i];
+	 }
+	 out << ']';
+      }
+      out << "],\"multisets\":[";
+      for(u32 i = 0; i < groups.size(); ++i) {
+	 out << (i > 0 ? "," : "") << "{\"smallest\":\"" << groups[i].first << "\",\"numbers\":\"" << u128_to_string(groups[i].second) << "\"}";
+      }
+      out << "]}\n";
+   } else if(format == OutputFormat::csv) {
+      out << "digits,target,smallest,numbers\n";
+      for(const auto &group : groups) {
+	 out << digits << ',' << target << ',' << group.first << ',' << u128_to_string(group.second) << '\n';
+      }
+   } else {
+      out << "numbers below 10^" << digits << " with a squigit of " << target << ": " << u128_to_string(tree.count_landing_on(target)) << '\n'
+	  << "numbers below 10^" << digits << " that go through " << target << ": " << u128_to_string(tree.count_reaching(target)) << '\n';
+      for(u32 k = 1; k < levels.size(); ++k) {
+	 out << "values " << k << (k == 1 ? " step" : " steps") << " away:";
+	 for(u32 v : levels[k]) {
+	    out << ' ' << v;
+	 }
+	 out << '\n';
+      }
+      out << "the numbers with a squigit of " << target << ", grouped by their digits:\n";
+      for(const auto &group : groups) {
+	 out << group.first << " and its " << u128_to_string(group.second) << " permutations\n";
+      }
+   }
+   std::cout << out.str();
+}
+
+
+/*
+Writes every number in [1, 10^digits) that reaches 89, one per line, and returns how many that was. Nothing here grows with the limit, the numbers only ever exist as the digits of the one we're on:
+- ascending keeps the current number as its decimal digits along with its squigit, like SquigitOdometer but with the characters themselves so writing one out is a copy.
+- grouped goes through the multisets like DigitsMethod does and, for every one that goes to 89, walks its distinct permutations with std::next_permutation (which skips the repeats by itself). A multiset's numbers come out in order, but the groups don't.
+The leading zeroes of the digits just get left off, since a multiset with zeroes in it is also the numbers with fewer digits.
+ */
+u128 stream_numbers(u32 digits, StreamOrder order, OutputBuffer &out)
+{
+   if(digits == 0 || digits > MAX_COUNT_DIGITS) {
+      throw std::out_of_range{"digit count must be between 1 and " + std::to_string(MAX_COUNT_DIGITS)};
+   }
+   const SquigitBitset bits = ChainOracle::instance().reaches_89_bits(squigit_bound(digits));
+   const TerminalBitset &reaches_89 = *bits;
+   char text[MAX_COUNT_DIGITS + 1];
+   u128 ans{0};
+
+   auto emit = [&out, &text, digits]() {
+      u32 first{0};
+      while(text[first] == '0') {
+	 ++first;
+      }
+      char *line = out.reserve(MAX_COUNT_DIGITS + 1);
+      std::memcpy(line, text + first, digits - first);
+      line[digits - first] = '\n';
+      out.commit(digits - first + 1);
+   };
+   
+   if(order == StreamOrder::ascending) {
+      std::fill(text, text + digits, '0');
+      u32 sum{0};
+      while(true) {
+	 // the same carry as SquigitOdometer::next(), from the last digit back
+	 u32 i{digits};
+	 while(i > 0 && text[i - 1] == '9') {
+	    text[--i] = '0';
+	    sum -= 81;
+	 }
+	 if(i == 0) {
+	    return ans;
+	 }
+	 const u32 d = static_cast<u32>(++text[i - 1] - '0');
+	 sum += 2 * d - 1;
+	 if(reaches_89.reaches_89(sum)) {
+	    emit();
+	    ++ans;
+	 }
+      }
+   }
+
+   for_each_digit_multiset(digits, [&](const u32 *counts, u32 squigit, u128) {
+      if(!reaches_89.reaches_89(squigit)) {
+	 return;
+      }
+      char *next = text;
+      for(u32 d = 0; d < 10; ++d) {
+	 next = std::fill_n(next, counts[d], static_cast<char>('0' + d));
+      }
+      do {
+	 emit();
+	 ++ans;
+      } while(std::next_permutation(text, text + digits));
+   });
+   return ans;
+}
+
+
+/*
+Works the bits out a segment at a time (so the memory use doesn't grow with the limit) with the same batch kernel SimdSquigitsMethod uses, split over the threads with parallel_blocks(), and writes each segment out as soon as it's done. Every block is a multiple of 64 numbers so no two threads ever touch the same word, and every word is 4 aligned batches of 16 so the kernel never straddles two 4 digit chunks.
+Returns how many numbers reach 89.
+ */
+u64 generate_bitset_file(u32 digits, u32 threads, const std::string &path)
+{
+   if(digits == 0 || digits > MAX_SCAN_DIGITS) {
+      throw std::out_of_range{"digit count must be between 1 and " + std::to_string(MAX_SCAN_DIGITS)};
+   }
+   if(threads == 0) {
+      threads = std::max(std::thread::hardware_concurrency(), 1u);
+   }
+   threads = std::min(threads, MAX_THREADS);
+
+   const u64 SEGMENT_WORDS{1 << 20}; // 8MB of bits at a time
+   const u64 limit = power(10, digits);
+   const u64 total_words = (limit + 63) / 64;
+   // the last word runs a little past the limit, so the bound is one digit bigger to cover those too (they get masked off anyway)
+   const SquigitBitset bits = ChainOracle::instance().reaches_89_bits(squigit_bound(digits + 1));
+   const TerminalBitset &reaches_89 = *bits;
+   const SquigitBatchFn kernel = squigit_batch_kernel();
+   const u16 *chunks = chunk_squigits();
+
+   BitsetFileHeader header{};
+   std::memcpy(header.magic, BITSET_MAGIC, sizeof(BITSET_MAGIC));
+   header.version = BITSET_VERSION;
+   header.base = 10;
+   header.exponent = 2;
+   header.digits = digits;
+   header.limit = limit;
+   header.words = total_words;
+   header.checksum = FNV_OFFSET;
+   
+   OutputBuffer out{path};
+   out.append(&header, sizeof(header));
+   std::vector<u64> segment(std::min(SEGMENT_WORDS, total_words));
+   
+   for(u64 first_word = 0; first_word < total_words; first_word += segment.size()) {
+      const u64 words = std::min<u64>(segment.size(), total_words - first_word);
+      header.count_89 += parallel_blocks(first_word, first_word + words, threads, std::max<u64>(words / (u64{threads} * 16), 1024), [&](u64 begin, u64 end) {
+	 u64 count{0};
+	 u32 squigits[SIMD_BATCH];
+	 for(u64 w = begin; w < end; ++w) {
+	    u64 word{0};
+	    for(u32 b = 0; b < 4; ++b) {
+	       const u64 first = w * 64 + b * SIMD_BATCH;
+	       kernel(squigit_chunked(first / CHUNK_SIZE, chunks), static_cast<u32>(first % CHUNK_SIZE), squigits);
+	       for(u32 j = 0; j < SIMD_BATCH; ++j) {
+		  word |= reaches_89.reaches_89(squigits[j]) << (b * SIMD_BATCH + j);
+	       }
+	    }
+	    if(w * 64 + 64 > limit) {
+	       word &= (u64{1} << (limit - w * 64)) - 1;
+	    }
+	    segment[w - first_word] = word;
+	    count += static_cast<u64>(__builtin_popcountll(word));
+	 }
+	 return count;
+      });
+      header.checksum = fnv_words(header.checksum, segment.data(), words);
+      out.append(segment.data(), words * 8);
+   }
+
+   out.write_at(0, &header, sizeof(header));
+   return header.count_89;
+}
+
+
+void lookup(const std::vector<std::string> &arguments, bool verify, OutputFormat format)
+{
+   if(arguments.empty()) {
+      throw std::invalid_argument{"lookup needs the file to look in, see --help"};
+   }
+   const BitsetFile file{arguments[0]};
+   if(verify && !file.verify()) {
+      throw std::runtime_error{"\"" + arguments[0] + "\" doesn't match its checksum"};
+   }
+
+   // straight into the OutputBuffer as we go instead of all at the end, so answers from stdin show up as soon as they're asked for
+   OutputBuffer out{};
+   auto write = [&](const std::string &line) {
+      out.append(line.data(), line.size());
+   };
+   if(format == OutputFormat::csv) {
+      write("number,reaches_89\n");
+   }
+   // like serve(), one that can't be answered gets an error line and the rest still get theirs
+   auto answer = [&](const std::string &text) {
+      u128 n{0};
+      try {
+	 n = parse_u128(text, "lookup");
+      } catch(const std::exception &) {
+	 write("error: " + text + " isn't a number up to 10^" + std::to_string(MAX_COUNT_DIGITS) + "\n");
+	 return;
+      }
+      if(n >= file.limit()) {
+	 write("error: " + text + " is past the end of the file, it only goes up to 10^" + std::to_string(file.digit_count()) + "\n");
+	 return;
+      }
+      const bool ans = file.reaches_89(static_cast<u64>(n));
+      if(format == OutputFormat::json) {
+	 write("{\"number\":\"" + text + "\",\"reaches_89\":" + (ans ? "true" : "false") + "}\n");
+      } else if(format == OutputFormat::csv) {
+	 write(text + (ans ? ",1\n" : ",0\n"));
+      } else {
+	 write(text + (ans ? " reaches 89\n" : " doesn't reach 89\n"));
+      }
+   };
+   
+   if(arguments.size() > 1) {
+      for(u32 i = 1; i < arguments.size(); ++i) {
+	 answer(arguments[i]);
+      }
+   } else {
+      std::ios::sync_with_stdio(false); // see serve(), otherwise in_avail() is always 0
+      std::string line{};
+      while(std::getline(std::cin, line)) {
+	 std::stringstream words{line};
+	 std::string word{};
+	 while(words >> word) {
+	    answer(word);
+	 }
+	 if(std::cin.rdbuf()->in_avail() <= 0) {
+	    out.flush(); // nothing else waiting, so whoever is typing them in gets their answers now
+	 }
+      }
+   }
+   out.flush();
+}
+
+
+// the answer below 10^digits mod modulus, see BarrettReducer
+u64 count_89_mod(u32 digits, u64 modulus)
+{
+   if(digits == 0 || digits > MAX_MODULAR_DIGITS) {
+      throw std::out_of_range{"digit count must be between 1 and " + std::to_string(MAX_MODULAR_DIGITS)};
+   }
+   if(modulus < 2 || modulus >= (u64{1} << 60)) {
+      throw std::out_of_range{"the modulus has to be between 2 and 2^60"};
    }
    
+   const BarrettReducer barrett{modulus};
+   const SquigitTable table = ChainOracle::instance().squigits_to_1(squigit_bound(digits));
+   const std::vector<char> &squigits_to_1 = *table;
+
+   std::vector<u64> count(81 * u64{digits} + 1, 0);
+   count[0] = 1;
+   for(u32 n = 1; n <= digits; ++n) {
+      for(u32 s = 81 * n; s > 0; --s) {
+	 u64 sum{count[s]};
+	 for(u32 d = 1; d <= 9 && d * d <= s; ++d) {
+	    sum += count[s - d * d];
+	 }
+	 count[s] = barrett.reduce(sum);
+      }
+   }
+
+   u64 ans{0};
+   for(u32 s = 1; s < count.size(); ++s) {
+      if(!squigits_to_1[s]) {
+	 ans = barrett.reduce(ans + count[s]);
+      }
+   }
+   return ans;
+}
+
+
+u64 mul_mod(u64 a, u64 b, u64 mod)
+{
+   return static_cast<u64>(u128{a} * b % mod);
+}
+
+
+u64 pow_mod(u64 base, u64 exp, u64 mod)
+{
+   u64 ans{1 % mod};
+   base %= mod;
+   while(exp != 0) {
+      if(exp & 1) {
+	 ans = mul_mod(ans, base, mod);
+      }
+      base = mul_mod(base, base, mod);
+      exp >>= 1;
+   }
    return ans;
 }
+
+
+// Miller-Rabin, these 7 bases are known to get every u64 right
+bool is_prime(u64 n)
+{
+   if(n < 2) {
+      return false;
+   }
+   for(u64 p : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+      if(n % p == 0) {
+	 return n == p;
+      }
+   }
+   
+   u64 odd{n - 1};
+   u32 twos{0};
+   while(odd % 2 == 0) {
+      odd /= 2;
+      ++twos;
+   }
+   for(u64 base : {2ull, 325ull, 9375ull, 28178ull, 450775ull, 9780504ull, 1795265022ull}) {
+      u64 x = pow_mod(base, odd, n);
+      if(x == 0 || x == 1 || x == n - 1) {
+	 continue;
+      }
+      bool composite{true};
+      for(u32 i = 1; i < twos && composite; ++i) {
+	 x = mul_mod(x, x, n);
+	 composite = (x != n - 1);
+      }
+      if(composite) {
+	 return false;
+      }
+   }
+   return true;
+}
+
+
+/*
+The exact answer below 10^digits: the answer is less than 10^digits, so it's enough to know it mod primes whose product is bigger than that. Each prime is just below 2^60 (the most count_89_mod() takes), so that's about one prime for every 18 digits of the limit.
+Garner's algorithm turns the remainders into mixed radix digits (ans = t0 + p0 * (t1 + p1 * (t2 + ...))), which only ever needs arithmetic mod one of the primes, and then the big number gets built with nothing but multiply by a prime and add.
+ */
+std::string count_89_exact(u32 digits)
+{
+   if(digits == 0 || digits > MAX_EXACT_DIGITS) {
+      throw std::out_of_range{"digit count for the exact answer must be between 1 and " + std::to_string(MAX_EXACT_DIGITS)};
+   }
+   std::vector<u64> primes{};
+   double bits{0};
+   for(u64 candidate = (u64{1} << 60) - 1; bits < digits * std::log2(10.0) + 1; candidate -= 2) {
+      if(is_prime(candidate)) {
+	 primes.push_back(candidate);
+	 bits += std::log2(static_cast<double>(candidate));
+      }
+   }
+
+   std::vector<u64> mixed(primes.size());
+   for(u32 i = 0; i < primes.size(); ++i) {
+      u64 x = count_89_mod(digits, primes[i]);
+      for(u32 j = 0; j < i; ++j) {
+	 const u64 difference = (x + primes[i] - mixed[j] % primes[i]) % primes[i];
+	 x = mul_mod(difference, pow_mod(primes[j] % primes[i], primes[i] - 2, primes[i]), primes[i]);
+      }
+      mixed[i] = x;
+   }
+
+   BigUnsigned ans{};
+   for(u64 i = primes.size(); i-- > 0;) {
+      ans.mul_add(primes[i], mixed[i]);
+   }
+   return ans.to_string();
+}
+
+
+// an answer mod modulus, or an exact one when modulus is 0
+void print_big_answer(u32 digits, u64 modulus, const std::string &answer, OutputFormat format)
+{
+   const std::string mod = modulus != 0 ? std::to_string(modulus) : std::string{};
+   
+   if(format == OutputFormat::json) {
+      std::cout << "{\"digits\":" << digits << ",\"modulus\":" << (modulus != 0 ? "\"" + mod + "\"" : std::string{"null"}) << ",\"answer\":\"" << answer << "\"}\n";
+   } else if(format == OutputFormat::csv) {
+      std::cout << "digits,modulus,answer\n" << digits << ',' << mod << ',' << answer << '\n';
+   } else if(modulus != 0) {
+      std::cout << "answer below 10^" << digits << " mod " << mod << ": " << answer << '\n';
+   } else {
+      std::cout << "exact answer below 10^" << digits << ": " << answer << '\n';
+   }
+}
+
+
+// iterative radix 2 Cooley-Tukey: put the values in bit reversed order, then combine pairs of halves of length 2, 4, 8, ...
+void ntt(std::vector<u64> &values, bool inverse)
+{
+   const u64 size = values.size();
+   for(u64 i = 1, j = 0; i < size; ++i) {
+      u64 bit = size >> 1;
+      for(; j & bit; bit >>= 1) {
+	 j ^= bit;
+      }
+      j ^= bit;
+      if(i < j) {
+	 std::swap(values[i], values[j]);
+      }
+   }
+
+   std::vector<u64> roots(size / 2 + 1);
+   for(u64 length = 2; length <= size; length <<= 1) {
+      // a primitive length-th root of unity, and its powers for every butterfly in the block
+      u64 root = Montgomery::pow(Montgomery::to_montgomery(NTT_GENERATOR), (NTT_PRIME - 1) / length);
+      if(inverse) {
+	 root = Montgomery::pow(root, NTT_PRIME - 2);
+      }
+      const u64 half = length / 2;
+      roots[0] = Montgomery::to_montgomery(1);
+      for(u64 k = 1; k < half; ++k) {
+	 roots[k] = Montgomery::mul(roots[k - 1], root);
+      }
+      
+      for(u64 start = 0; start < size; start += length) {
+	 for(u64 k = 0; k < half; ++k) {
+	    const u64 even = values[start + k];
+	    const u64 odd = Montgomery::mul(values[start + k + half], roots[k]);
+	    values[start + k] = Montgomery::add(even, odd);
+	    values[start + k + half] = Montgomery::sub(even, odd);
+	 }
+      }
+   }
+
+   if(inverse) {
+      const u64 scale = Montgomery::pow(Montgomery::to_montgomery(size), NTT_PRIME - 2);
+      for(u64 &value : values) {
+	 value = Montgomery::mul(value, scale);
+      }
+   }
+}
+
+
+/*
+The squigit distribution of N digit strings is just the coefficients of (x^0 + x^1 + x^4 + ... + x^81)^N, since multiplying the polynomials for two sets of digits adds up their squigits for every way of picking one from each. That's a polynomial of degree 81N, so with a transform at least that long nothing wraps around, and the transform turns taking a polynomial to the N-th power into taking every one of its values to the N-th power on its own. So it's one transform, a pow() per point and one transform back, O(81N log N) instead of the DP's O(81N^2), and then the coefficients go through squigits_to_1 like always.
+It's all mod NTT_PRIME, since that's what the transform works in.
+ */
+u64 count_89_ntt(u32 digits)
+{
+   if(digits == 0 || digits > MAX_NTT_DIGITS) {
+      throw std::out_of_range{"digit count must be between 1 and " + std::to_string(MAX_NTT_DIGITS)};
+   }
+   
+   const u64 degree = 81 * u64{digits};
+   u64 size{1};
+   while(size <= degree) {
+      size <<= 1;
+   }
+   
+   std::vector<u64> values(size, 0);
+   for(u32 d = 0; d <= 9; ++d) {
+      values[d * d] = Montgomery::to_montgomery(1);
+   }
+   ntt(values, false);
+   for(u64 &value : values) {
+      value = Montgomery::pow(value, digits);
+   }
+   ntt(values, true);
+
+   const SquigitTable table = ChainOracle::instance().squigits_to_1(squigit_bound(digits));
+   const std::vector<char> &squigits_to_1 = *table;
+   u64 ans{0};
+   for(u64 s = 1; s <= degree; ++s) {
+      if(!squigits_to_1[s]) {
+	 ans = Montgomery::add(ans, values[s]);
+      }
+   }
+   return Montgomery::from_montgomery(ans);
+}
+
+
+/*
+Every method should give the same answer, and every new kernel is one more place for them not to (the uninitialized squigits_to_1 entries above 567 and the fact(0) hang both got past me for a while), so this checks all of them against each other:
+- every registered method at every limit from 10^1 to 10^scan_digits, with every kernel for the ones that scan and on threads (or 2) threads for the multithreaded ones, against BruteForceMethod with the reference kernel,
+- the methods that don't scan from there up to 10^VALIDATE_COUNT_DIGITS against count_89_exact(), which has nothing in common with them apart from the squigit distributions,
+- RangeCounter against all of the above for whole limits, and against counting random ranges one number at a time, both small ones and ones up near 10^38,
+- and at the limits in VALIDATE_BIG_DIGITS, count_89_exact() against count_89_mod() for a few moduli and against count_89_ntt(), since all three get there differently.
+It prints a line for everything it checked and a MISMATCH line for anything that disagrees, and throws at the end if there were any, so p92 exits with 1.
+ */
+void validate(u32 scan_digits, u32 threads)
+{
+   if(scan_digits == 0 || scan_digits > MAX_SCAN_DIGITS) {
+      throw std::out_of_range{"digit count must be between 1 and " + std::to_string(MAX_SCAN_DIGITS)};
+   }
+   const u32 parallel_threads = std::max(threads, 2u);
+
+   u32 checks{0};
+   u32 failures{0};
+   auto check = [&](const std::string &what, const std::string &got, const std::string &expected) {
+      ++checks;
+      if(got != expected) {
+	 ++failures;
+	 std::cout << "MISMATCH: " << what << " gave " << got << ", expected " << expected << '\n';
+      }
+   };
+
+   const RangeCounter range_counter{};
+   const SquigitKernel kernels[]{SquigitKernel::reference, SquigitKernel::chunked, SquigitKernel::incremental, SquigitKernel::blocked};
+
+   u128 limit{1};
+   for(u32 digits = 1; digits <= std::max(scan_digits, VALIDATE_COUNT_DIGITS); ++digits) {
+      limit *= 10;
+      const bool scanning = digits <= scan_digits;
+      std::string expected{};
+      std::string reference{};
+      if(scanning) {
+	 const BruteForceMethod brute_force{digits};
+	 expected = u128_to_string(brute_force.benchmark(0, 1).answer);
+	 reference = brute_force.class_type;
+      } else {
+	 expected = count_89_exact(digits);
+	 reference = "count_89_exact";
+      }
+
+      u32 runs{0};
+      auto run = [&](const MethodInfo &info, const MethodConfig &config) {
+	 const std::unique_ptr<Method> method = info.factory(config);
+	 check(method->class_type + " below 10^" + std::to_string(digits), u128_to_string(method->benchmark(0, 1).answer), expected);
+	 ++runs;
+      };
+
+      for(const MethodInfo &info : MethodRegistry::instance().methods()) {
+	 const MethodCapabilities &caps = info.capabilities;
+	 if(digits > caps.max_digits || (caps.scans_numbers && !scanning)) {
+	    continue;
+	 }
+	 MethodConfig config{};
+	 config.digits = digits;
+	 if(caps.scans_numbers) {
+	    for(SquigitKernel kernel : kernels) {
+	       config.kernel = kernel;
+	       run(info, config);
+	    }
+	    config.kernel = SquigitKernel::chunked; // the threads don't care which kernel it is, so they only get checked with the fast one
+	 } else {
+	    run(info, config);
+	 }
+	 if(caps.multithreaded) {
+	    config.threads = parallel_threads;
+	    run(info, config);
+	 }
+      }
+
+      check("RangeCounter below 10^" + std::to_string(digits), u128_to_string(range_counter.count(1, limit)), expected);
+      std::cout << "below 10^" << digits << ": " << runs << " runs and RangeCounter checked against " << reference << " (" << expected << ")\n";
+   }
+
+   // the squigit of a u128, digit by digit, so the ranges up near 10^38 can be counted one number at a time
+   auto squigit_of = [](u128 val) {
+      u32 ans{0};
+      for(; val != 0; val /= 10) {
+	 const u32 digit = static_cast<u32>(val % 10);
+	 ans += digit * digit;
+      }
+      return ans;
+   };
+   ChainOracle &oracle = ChainOracle::instance();
+
+   std::mt19937_64 random{92}; // the same ranges every time, so a failure can be reproduced
+   u128 top{1};
+   for(u32 i = 0; i < MAX_COUNT_DIGITS; ++i) {
+      top *= 10;
+   }
+   const u64 max_width{10000};
+   const u128 range_tops[]{power(10, scan_digits), top - max_width};
+   for(u128 range_top : range_tops) {
+      for(u32 i = 0; i < VALIDATE_RANGES; ++i) {
+	 const u128 from = ((u128{random()} << 64) | random()) % range_top;
+	 const u128 to = from + random() % max_width;
+	 u64 counted{0};
+	 for(u128 n = std::max<u128>(from, 1); n < to; ++n) {
+	    counted += oracle.reaches_89(squigit_of(n));
+	 }
+	 check("RangeCounter over [" + u128_to_string(from) + ", " + u128_to_string(to) + ")", u128_to_string(range_counter.count(from, to)), std::to_string(counted));
+      }
+   }
+   std::cout << "RangeCounter: " << 2 * VALIDATE_RANGES << " random ranges below 10^" << scan_digits << " and 10^" << MAX_COUNT_DIGITS << " checked one number at a time\n";
+
+   // the exact answer mod m, one decimal digit at a time
+   auto string_mod = [](const std::string &text, u64 modulus) {
+      u64 ans{0};
+      for(char c : text) {
+	 ans = static_cast<u64>((u128{ans} * 10 + static_cast<u32>(c - '0')) % modulus);
+      }
+      return std::to_string(ans);
+   };
+   const u64 moduli[]{1000000007, 998244353, power(10, 18)};
+
+   for(u32 digits : VALIDATE_BIG_DIGITS) {
+      const std::string exact = count_89_exact(digits);
+      const std::string below = " below 10^" + std::to_string(digits);
+      if(digits <= MAX_COUNT_DIGITS) {
+	 check("RangeCounter" + below, u128_to_string(range_counter.count(1, top)), exact);
+      }
+      for(u64 modulus : moduli) {
+	 check("count_89_mod mod " + std::to_string(modulus) + below, std::to_string(count_89_mod(digits, modulus)), string_mod(exact, modulus));
+      }
+      check("count_89_ntt" + below, std::to_string(count_89_ntt(digits)), string_mod(exact, NTT_PRIME));
+      std::cout << "below 10^" << digits << ": count_89_mod and count_89_ntt checked against count_89_exact (" << exact.size() << " digits)\n";
+   }
+
+   if(failures != 0) {
+      throw std::runtime_error{"validate: " + std::to_string(failures) + " of " + std::to_string(checks) + " checks failed"};
+   }
+   std::cout << "validate: all " << checks << " checks passed\n";
+}
+
+
+// 10^digits / seconds written out in scientific notation, working in logs since 10^1000 is way past what a double holds
+std::string numbers_per_second(u32 digits, double ns)
+{
+   const double log_rate = digits - std::log10(ns / 1e9);
+   double exponent = std::floor(log_rate);
+   double mantissa = std::pow(10.0, log_rate - exponent);
+   if(mantissa >= 9.9995) { // it would print as 10.000
+      mantissa /= 10;
+      exponent += 1;
+   }
+   std::ostringstream out{};
+   out << std::fixed << std::setprecision(3) << mantissa << "e+" << static_cast<int>(exponent);
+   return out.str();
+}
+
+
+/*
+One CSV line for every method at every limit and thread count, so how they scale can be plotted instead of me writing timings down in comments:
+- the scanning methods at every limit from 10^SCALE_FIRST_DIGITS to 10^digits (10^SCALE_SCAN_DIGITS unless --digits says otherwise) with the --kernel they were given,
+- the methods that count combinations or squigits at the limits in SCALE_COUNT_DIGITS that they can handle,
+- and count_89_exact(), count_89_mod() and count_89_ntt() at the limits in SCALE_BIG_DIGITS.
+The multithreaded methods go through 1, 2, 4 and so on threads up to the number of cores (or --threads), and the top count itself. Every point is the median of --runs timed runs after --warmup untimed ones, numbers_per_second is how many starting numbers that is per second (the limit over the median time, even for the methods that never look at a single number), and speedup and parallel_efficiency compare it against the 1 thread run of the same method at the same limit (the efficiency is the speedup over the thread count).
+ */
+void scale(const Options &options, u32 scan_digits, u32 max_threads)
+{
+   if(scan_digits < SCALE_FIRST_DIGITS || scan_digits > MAX_SCAN_DIGITS) {
+      throw std::out_of_range{"scale needs a digit count between " + std::to_string(SCALE_FIRST_DIGITS) + " and " + std::to_string(MAX_SCAN_DIGITS)};
+   }
+   if(max_threads == 0) {
+      max_threads = std::max(std::thread::hardware_concurrency(), 1u);
+   }
+   max_threads = std::min(max_threads, MAX_THREADS);
+
+   std::vector<u32> thread_counts{};
+   for(u32 threads = 1; threads < max_threads; threads *= 2) {
+      thread_counts.push_back(threads);
+   }
+   thread_counts.push_back(max_threads);
+
+   // the engines past u128 aren't Methods, so they get timed here the same way benchmark() would
+   const u64 modulus{1000000007};
+   struct Engine {
+      const char *name;
+      std::string (*count)(u32 digits, u64 modulus);
+   };
+   const Engine engines[]{
+      {"count_89_exact", [](u32 digits, u64) { return count_89_exact(digits); }},
+      {"count_89_mod", [](u32 digits, u64 mod) { return std::to_string(count_89_mod(digits, mod)); }},
+      {"count_89_ntt", [](u32 digits, u64) { return std::to_string(count_89_ntt(digits)); }},
+   };
+   const MethodRegistry &registry = MethodRegistry::instance();
+   for(const std::string &name : options.methods) {
+      if(std::none_of(std::begin(engines), std::end(engines), [&](const Engine &engine) { return name == engine.name; })) {
+	 registry.find(name); // throws for a typo before we've timed anything
+      }
+   }
+
+   std::cout << "kind,method,digits,threads,answer,median_ns,numbers_per_second,speedup,parallel_efficiency\n";
+   auto print_point = [](const char *kind, const std::string &name, u32 digits, u32 threads, const std::string &answer, double median_ns, double single_thread_ns) {
+      const double speedup = single_thread_ns / median_ns;
+      std::cout << kind << ',' << name << ',' << digits << ',' << threads << ',' << answer
+		<< ',' << std::fixed << std::setprecision(0) << median_ns
+		<< ',' << numbers_per_second(digits, median_ns)
+		<< ',' << std::setprecision(3) << speedup << ',' << speedup / threads << '\n';
+      std::cout.unsetf(std::ios::floatfield);
+   };
+
+   for(const MethodInfo &info : registry.methods()) {
+      if(!options.methods.empty() && std::find(options.methods.begin(), options.methods.end(), info.name) == options.methods.end()) {
+	 continue;
+      }
+      const MethodCapabilities &caps = info.capabilities;
+
+      std::vector<u32> limits{};
+      if(caps.scans_numbers) {
+	 for(u32 digits = SCALE_FIRST_DIGITS; digits <= std::min(scan_digits, caps.max_digits); ++digits) {
+	    limits.push_back(digits);
+	 }
+      } else {
+	 for(u32 digits : SCALE_COUNT_DIGITS) {
+	    if(digits <= caps.max_digits) {
+	       limits.push_back(digits);
+	    }
+	 }
+      }
+
+      for(u32 digits : limits) {
+	 double single_thread_ns{0};
+	 for(u32 threads : thread_counts) {
+	    if(threads > 1 && !caps.multithreaded) {
+	       break;
+	    }
+	    MethodConfig config{options.config};
+	    config.digits = digits;
+	    config.threads = threads;
+	    const std::unique_ptr<Method> method = info.factory(config);
+	    const BenchmarkStats stats = method->benchmark(options.warmup_runs, options.timed_runs);
+	    if(threads == 1) {
+	       single_thread_ns = stats.median_ns;
+	    }
+	    print_point(caps.scans_numbers ? "scan" : "count", info.name, digits, threads, u128_to_string(stats.answer), stats.median_ns, single_thread_ns);
+	 }
+      }
+   }
+
+   for(const Engine &engine : engines) {
+      if(!options.methods.empty() && std::find(options.methods.begin(), options.methods.end(), engine.name) == options.methods.end()) {
+	 continue;
+      }
+      for(u32 digits : SCALE_BIG_DIGITS) {
+	 for(u32 i = 0; i < options.warmup_runs; ++i) {
+	    engine.count(digits, modulus);
+	 }
+	 std::string answer{};
+	 std::vector<double> times{};
+	 for(u32 i = 0; i < std::max(options.timed_runs, 1u); ++i) {
+	    auto start = steady_clock::now();
+	    answer = engine.count(digits, modulus);
+	    auto stop = steady_clock::now();
+	    times.push_back(static_cast<double>(duration_cast<nanoseconds>(stop - start).count()));
+	 }
+	 std::sort(times.begin(), times.end());
+	 const u32 n = static_cast<u32>(times.size());
+	 const double median_ns = n % 2 == 1 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2;
+	 print_point("big", engine.name, digits, 1, answer, median_ns, median_ns);
+      }
+   }
+}